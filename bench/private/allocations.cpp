@@ -0,0 +1,215 @@
+#include <log/log.hpp>
+#include <order_book/order_book.hpp>
+#include <order_book/workload.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+using namespace flob;
+
+namespace
+{
+    std::atomic<uint64> allocations = 0;
+
+    auto count_allocation() noexcept -> void
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Vector grows trivially relocatable elements with realloc, and SmallVector spills through operator new, which glibc
+// serves from malloc. With glibc the whole malloc family is thus counted, operator new included. Elsewhere only
+// operator new is seen.
+#if defined(__GLIBC__)
+extern "C"
+{
+    auto __libc_malloc(std::size_t size) noexcept -> void*;
+    auto __libc_calloc(std::size_t count, std::size_t size) noexcept -> void*;
+    auto __libc_realloc(void* pointer, std::size_t size) noexcept -> void*;
+    auto __libc_memalign(std::size_t alignment, std::size_t size) noexcept -> void*;
+
+    auto malloc(std::size_t size) noexcept -> void*
+    {
+        count_allocation();
+        return __libc_malloc(size);
+    }
+
+    auto calloc(std::size_t count, std::size_t size) noexcept -> void*
+    {
+        count_allocation();
+        return __libc_calloc(count, size);
+    }
+
+    auto realloc(void* pointer, std::size_t size) noexcept -> void*
+    {
+        count_allocation();
+        return __libc_realloc(pointer, size);
+    }
+
+    auto aligned_alloc(std::size_t alignment, std::size_t size) noexcept -> void*
+    {
+        count_allocation();
+        return __libc_memalign(alignment, size);
+    }
+}
+#endif
+
+auto operator new(std::size_t size) -> void*
+{
+#if !defined(__GLIBC__)
+    count_allocation();
+#endif
+    if (auto* pointer = std::malloc(size > 0 ? size : 1))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator new(std::size_t size, std::align_val_t alignment) -> void*
+{
+#if !defined(__GLIBC__)
+    count_allocation();
+#endif
+    const auto align = static_cast<std::size_t>(alignment);
+    if (auto* pointer = std::aligned_alloc(align, (size + align - 1) / align * align))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator delete(void* pointer) noexcept -> void
+{
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer, std::size_t) noexcept -> void
+{
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer, std::align_val_t) noexcept -> void
+{
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer, std::size_t, std::align_val_t) noexcept -> void
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    constexpr usize warmup   = 1'000'000;
+    constexpr usize commands = 1'000'000;
+
+    enum class Operation : uint8
+    {
+        Add,     // Rests without trading
+        Cancel,
+        Modify,  // Rests again without trading
+        Match,   // Add or modify that traded
+        Infos,
+        Count,
+    };
+
+    constexpr const char* operation_names[] = {"add", "cancel", "modify", "match", "infos"};
+
+    struct Counters
+    {
+        uint64 operations[static_cast<usize>(Operation::Count)]  = {};
+        uint64 allocations[static_cast<usize>(Operation::Count)] = {};
+
+        auto record(Operation operation, uint64 allocated) -> void
+        {
+            ++operations[static_cast<usize>(operation)];
+            allocations[static_cast<usize>(operation)] += allocated;
+        }
+    };
+
+    auto classify(const OrderCommand& command, const Trades& trades) -> Operation
+    {
+        if (!trades.empty())
+        {
+            return Operation::Match;
+        }
+        switch (command.type)
+        {
+            case CommandType::Add:    return Operation::Add;
+            case CommandType::Cancel: return Operation::Cancel;
+            default:                  return Operation::Modify;
+        }
+    }
+}
+
+// Warms a book with preallocated capacity up on synthetic flow, then counts the allocations of every operation of
+// the same flow. Fails when any steady state operation allocates.
+auto main() -> int32
+{
+    WorkloadConfig    workload;
+    WorkloadGenerator generator(workload);
+    const auto        flow = generator.generate(warmup + commands);
+
+    OrderBookConfig config;
+    config.manual_clock   = true;
+    config.order_capacity = workload.max_live_orders * 2;
+    config.level_capacity = 4096;
+
+    const auto before = allocations.load();
+    OrderBook  book(config);
+    const auto setup = allocations.load() - before;
+
+    // Buffers reused across operations, they only grow during the warmup.
+    Trades         trades;
+    OrderBookInfos infos;
+    infos.bids.reserve(config.level_capacity);
+    infos.asks.reserve(config.level_capacity);
+    for (usize i = 0; i < warmup; ++i)
+    {
+        trades.clear();
+        book.apply(flow[i], trades);
+        if (i % 64 == 0)
+        {
+            book.infos(infos);
+        }
+    }
+
+    Counters counters;
+    for (usize i = warmup; i < flow.size(); ++i)
+    {
+        trades.clear();
+
+        auto start = allocations.load(std::memory_order_relaxed);
+        book.apply(flow[i], trades);
+        counters.record(classify(flow[i], trades), allocations.load(std::memory_order_relaxed) - start);
+
+        if (i % 64 == 0)
+        {
+            start = allocations.load(std::memory_order_relaxed);
+            book.infos(infos);
+            counters.record(Operation::Infos, allocations.load(std::memory_order_relaxed) - start);
+        }
+    }
+
+    uint64 total = 0;
+    Log::info("{:>8} | {:>10} | {:>12} | {:>10}", "op", "count", "allocations", "per op");
+    for (usize i = 0; i < static_cast<usize>(Operation::Count); ++i)
+    {
+        const auto operations = std::max<uint64>(counters.operations[i], 1);
+        Log::info("{:>8} | {:>10} | {:>12} | {:>10.4f}", operation_names[i], counters.operations[i], counters.allocations[i],
+                  static_cast<float64>(counters.allocations[i]) / static_cast<float64>(operations));
+        total += counters.allocations[i];
+    }
+    Log::info("{} allocations to set the book up, {} resting orders.", setup, book.size());
+
+    if (total > 0)
+    {
+        Log::error("Steady state operations allocated {} times.", total);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
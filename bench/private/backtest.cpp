@@ -0,0 +1,61 @@
+#include <log/log.hpp>
+#include <simulation/backtest_runner.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace flob;
+
+// Runs the same parameter sweep with 1, 2, 4, ... workers up to the core count and reports the scaling and the share
+// of worker time lost to scheduling.
+auto main() -> int32
+{
+    constexpr usize jobs_count = 256;
+    constexpr usize commands   = 25'000;
+
+    // A sweep over the seed and the mix of aggressive flow, so simulations take uneven time.
+    Vector<BacktestJob> jobs;
+    jobs.reserve(jobs_count);
+    for (usize i = 0; i < jobs_count; ++i)
+    {
+        BacktestJob job;
+        job.book.session        = new_york_session;
+        job.workload.seed       = 1'000 + i;
+        job.workload.mix.ioc    = 0.01 + 0.0002 * i;
+        job.workload.mix.market = 0.005 + 0.0001 * i;
+        job.commands            = commands * (1 + i % 4);
+        jobs.push_back(job);
+    }
+
+    const auto cores = std::max<usize>(std::thread::hardware_concurrency(), 1);
+
+    Vector<usize> worker_counts;
+    for (usize workers = 1; workers < cores; workers *= 2)
+    {
+        worker_counts.push_back(workers);
+    }
+    worker_counts.push_back(cores);
+
+    float64 baseline = 0.0;
+    Log::info("{:>8} | {:>10} | {:>12} | {:>8} | {:>10} | {:>8} | {:>8}", "workers", "wall ms", "commands/s", "speedup", "efficiency", "overhead", "steals");
+    for (const auto workers : worker_counts)
+    {
+        BacktestRunner runner(workers);
+        const auto     results = runner.run(jobs);
+        const auto&    stats   = runner.stats();
+
+        uint64 total = 0;
+        for (const auto& result : results)
+        {
+            total += result.commands;
+        }
+
+        const auto seconds    = std::chrono::duration<float64>(stats.wall).count();
+        const auto throughput = static_cast<float64>(total) / seconds;
+        baseline              = workers == 1 ? throughput : baseline;
+
+        const auto speedup = throughput / baseline;
+        Log::info("{:>8} | {:>10.1f} | {:>12.0f} | {:>7.2f}x | {:>9.1f}% | {:>7.2f}% | {:>8}", workers, seconds * 1'000.0, throughput, speedup,
+                  100.0 * speedup / workers, 100.0 * stats.overhead(), stats.steals);
+    }
+}
@@ -0,0 +1,143 @@
+#include <log/log.hpp>
+#include <market_data/consolidated_book.hpp>
+#include <order_book/order_book.hpp>
+#include <order_book/workload.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+
+using namespace flob;
+
+namespace
+{
+    constexpr usize commands = 200'000;  // Per venue
+    constexpr usize levels   = 10;
+    constexpr usize reads    = 100'000;
+
+    using Books = Vector<std::unique_ptr<OrderBook>>;
+
+    // One flow per venue, each around a slightly different mid.
+    auto make_flows(usize count) -> Vector<CommandBuffer>
+    {
+        Vector<CommandBuffer> flows;
+        for (usize i = 0; i < count; ++i)
+        {
+            WorkloadConfig workload;
+            workload.seed      = 42 + i;
+            workload.mid_price = static_cast<Price>(10'000 + i % 3);
+            flows.push_back(WorkloadGenerator(workload).generate(commands));
+        }
+        return flows;
+    }
+
+    auto make_books(usize count, ConsolidatedBook* consolidated) -> Books
+    {
+        Books books;
+        for (usize i = 0; i < count; ++i)
+        {
+            OrderBookConfig config;
+            config.manual_clock = true;
+            config.consolidated = consolidated;
+            config.venue        = i;
+            books.push_back(std::make_unique<OrderBook>(config));
+        }
+        return books;
+    }
+
+    // Nanoseconds per command, the venues taking turns.
+    auto replay(const Vector<CommandBuffer>& flows, Books& books) -> float64
+    {
+        Trades     trades;
+        const auto start = std::chrono::steady_clock::now();
+        for (usize i = 0; i < commands; ++i)
+        {
+            for (usize venue = 0; venue < books.size(); ++venue)
+            {
+                trades.clear();
+                books[venue]->apply(flows[venue][i], trades);
+            }
+        }
+        const auto total = static_cast<float64>(commands * books.size());
+        return std::chrono::duration<float64, std::nano>(std::chrono::steady_clock::now() - start).count() / total;
+    }
+
+    // Top bid levels rebuilt from infos() copies of every book, the way a consumer without the consolidated view would
+    // merge them: all levels sorted together, then equal prices summed.
+    auto rebuild(const Books& books, OrderBookInfos& infos, Vector<ConsolidatedLevel>& levels_of_all, Vector<ConsolidatedLevel>& merged) -> void
+    {
+        levels_of_all.clear();
+        for (const auto& book : books)
+        {
+            book->infos(infos);
+            for (const auto& level : infos.bids)
+            {
+                levels_of_all.push_back(ConsolidatedLevel(level.price, level.quantity, 1));
+            }
+        }
+        std::sort(levels_of_all.begin(), levels_of_all.end(), [](const ConsolidatedLevel& a, const ConsolidatedLevel& b) { return a.price > b.price; });
+
+        merged.clear();
+        for (const auto& level : levels_of_all)
+        {
+            if (!merged.empty() && merged.back().price == level.price)
+            {
+                merged.back().quantity += level.quantity;
+                ++merged.back().venues;
+            }
+            else if (merged.size() == levels)
+            {
+                break;
+            }
+            else
+            {
+                merged.push_back(level);
+            }
+        }
+    }
+
+    template <typename Read>
+    auto per_read(Read&& read) -> float64
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (usize i = 0; i < reads; ++i)
+        {
+            read();
+        }
+        return std::chrono::duration<float64, std::nano>(std::chrono::steady_clock::now() - start).count() / reads;
+    }
+}
+
+// Replays the same per venue flows with and without a consolidated view over the books, then compares reading its top
+// levels with rebuilding them from infos() copies. Fails when both disagree.
+auto main() -> int32
+{
+    Log::info("{:>6} | {:>10} | {:>12} | {:>8} | {:>12} | {:>14}", "venues", "ns/cmd", "consolidated", "overhead", "depth(10) ns", "rebuild ns");
+    for (const usize count : {1, 2, 4, 8, 16})
+    {
+        const auto flows    = make_flows(count);
+        auto       plain    = make_books(count, nullptr);
+        const auto baseline = replay(flows, plain);
+
+        ConsolidatedBook consolidated(count);
+        auto             books = make_books(count, &consolidated);
+        const auto       fed   = replay(flows, books);
+
+        Vector<ConsolidatedLevel> depth;
+        Vector<ConsolidatedLevel> levels_of_all;
+        Vector<ConsolidatedLevel> merged;
+        OrderBookInfos            infos;
+
+        const auto read      = per_read([&] { consolidated.depth(Side::Buy, levels, depth); });
+        const auto rebuilt   = per_read([&] { rebuild(books, infos, levels_of_all, merged); });
+        const auto identical = depth.size() == merged.size() && std::equal(depth.begin(), depth.end(), merged.begin());
+
+        Log::info("{:>6} | {:>10.1f} | {:>12.1f} | {:>7.1f}% | {:>12.1f} | {:>14.1f}", count, baseline, fed, 100.0 * (fed - baseline) / baseline, read, rebuilt);
+        if (!identical)
+        {
+            Log::error("Consolidated depth differs from the rebuilt one with {} venues", count);
+            return EXIT_FAILURE;
+        }
+    }
+}
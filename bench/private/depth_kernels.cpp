@@ -0,0 +1,169 @@
+#include <log/log.hpp>
+#include <misc/random.hpp>
+#include <order_book/order_book.hpp>
+#include <simd/depth_kernels.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <string>
+
+using namespace flob;
+
+namespace
+{
+    constexpr Price levels = 10'000;
+    constexpr usize calls  = 10'000;
+    constexpr usize rounds = 5;
+
+    struct Result
+    {
+        float64 nanoseconds;  // Per call, best round
+        uint64  value;        // Of the last call, to check that every variant agrees
+    };
+
+    // `run` does one call and returns a value that depends on all of its work, so that it is not optimized away.
+    template <typename Run>
+    auto measure(Run&& run) -> Result
+    {
+        Result result(0.0, 0);
+        for (usize round = 0; round < rounds; ++round)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (usize i = 0; i < calls; ++i)
+            {
+                result.value = run();
+            }
+            const auto nanoseconds = std::chrono::duration<float64, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+            result.nanoseconds     = round == 0 ? nanoseconds : std::min(result.nanoseconds, nanoseconds);
+        }
+        return result;
+    }
+
+    // Asks on `levels` consecutive prices, each with a few orders of random size.
+    auto fill(OrderBook& book) -> void
+    {
+        Random random;
+        uint64 id = 0;
+        for (Price level = 0; level < levels; ++level)
+        {
+            const auto orders = random.range(1, 4);
+            for (int64 i = 0; i < orders; ++i)
+            {
+                const auto quantity = static_cast<Quantity>(random.range(1, 1'000));
+                book.apply(OrderCommand(0, OrderId(++id), 100'001 + level, quantity, CommandType::Add, OrderType::GTC, Side::Sell));
+            }
+        }
+    }
+
+    auto cell(const Result& result, const Result& baseline) -> std::string
+    {
+        return std::format("{:.0f} ns ({:.1f}x)", result.nanoseconds, baseline.nanoseconds / result.nanoseconds);
+    }
+}
+
+// Runs cumulative depth, threshold search and VWAP over a 10k level side three ways: the scalar loop a caller of
+// infos() writes over its levels, then the scalar and the vectorized kernels over depth_levels(). Fails when they
+// disagree.
+auto main() -> int32
+{
+    OrderBookConfig config;
+    config.manual_clock = true;
+    OrderBook book(config);
+    fill(book);
+
+    OrderBookInfos infos;
+    DepthLevels    depth;
+    const auto     snapshot_infos = measure([&] {
+        book.infos(infos);
+        return infos.asks.size();
+    });
+    const auto     snapshot_depth = measure([&] {
+        book.depth_levels(Side::Sell, depth);
+        return depth.size();
+    });
+    Log::info("{} levels, snapshot {:.0f} ns with infos(), {:.0f} ns with depth_levels(), kernels: {}", depth.size(), snapshot_infos.nanoseconds,
+              snapshot_depth.nanoseconds, to_string(simd_level()));
+
+    const auto& asks       = infos.asks;
+    const auto* prices     = depth.prices().data();
+    const auto* quantities = depth.quantities().data();
+    const auto  size       = depth.size();
+    const auto  threshold  = depth.quantity(size) * 9 / 10;
+
+    Vector<uint64> cumulative(size);
+
+    struct Query
+    {
+        const char* name;
+        Result      loop;
+        Result      kernels[2];  // Indexed by SimdLevel
+    };
+
+    Query queries[3] = {{"cumulative", {}, {}}, {"threshold", {}, {}}, {"vwap", {}, {}}};
+
+    queries[0].loop = measure([&] {
+        uint64 total = 0;
+        for (usize i = 0; i < asks.size(); ++i)
+        {
+            total += asks[i].quantity;
+            cumulative[i] = total;
+        }
+        return cumulative[size / 2] + cumulative[size - 1];
+    });
+    queries[1].loop = measure([&] {
+        uint64 total = 0;
+        for (usize i = 0; i < asks.size(); ++i)
+        {
+            total += asks[i].quantity;
+            if (total >= threshold)
+            {
+                return static_cast<uint64>(i);
+            }
+        }
+        return static_cast<uint64>(asks.size());
+    });
+    queries[2].loop = measure([&] {
+        uint64 quantity = 0;
+        uint64 notional = 0;
+        for (const auto& level : asks)
+        {
+            quantity += level.quantity;
+            notional += static_cast<uint64>(level.price) * level.quantity;
+        }
+        return notional / quantity;
+    });
+
+    for (const auto level : {SimdLevel::Scalar, SimdLevel::Avx2})
+    {
+        const auto& kernels = depth_kernels(level);
+        const auto  index   = static_cast<usize>(level);
+
+        queries[0].kernels[index] = measure([&] {
+            kernels.prefix_sum(quantities, cumulative.data(), size);
+            return cumulative[size / 2] + cumulative[size - 1];
+        });
+        queries[1].kernels[index] = measure([&] { return static_cast<uint64>(kernels.find_cumulative(quantities, size, threshold)); });
+        queries[2].kernels[index] = measure([&] { return kernels.dot(prices, quantities, size) / kernels.sum(quantities, size); });
+    }
+
+    const auto vectorized = simd_level() != SimdLevel::Scalar;
+
+    bool agree = true;
+    Log::info("{:>10} | {:>18} | {:>18} | {:>18}", "query", "infos() loop", "scalar kernel", vectorized ? "avx2 kernel" : "-");
+    for (const auto& query : queries)
+    {
+        const auto& scalar = query.kernels[static_cast<usize>(SimdLevel::Scalar)];
+        const auto& avx2   = query.kernels[static_cast<usize>(SimdLevel::Avx2)];
+        Log::info("{:>10} | {:>18} | {:>18} | {:>18}", query.name, std::format("{:.0f} ns", query.loop.nanoseconds), cell(scalar, query.loop),
+                  vectorized ? cell(avx2, query.loop) : std::string("-"));
+        agree = agree && scalar.value == query.loop.value && avx2.value == query.loop.value;
+    }
+
+    if (!agree)
+    {
+        Log::error("Kernels disagree with the infos() loop");
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,98 @@
+#include <log/log.hpp>
+#include <market_data/depth_view.hpp>
+#include <order_book/order_book.hpp>
+#include <order_book/workload.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace flob;
+
+namespace
+{
+    constexpr usize commands = 2'000'000;
+    constexpr usize rounds   = 5;
+
+    auto replay(const CommandBuffer& flow, DepthView* view) -> float64
+    {
+        OrderBookConfig config;
+        config.manual_clock = true;
+        config.view         = view;
+        OrderBook book(config);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& command : flow)
+        {
+            book.apply(command);
+        }
+        return std::chrono::duration<float64, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<float64>(flow.size());
+    }
+
+    // A snapshot mixing two versions would show levels out of order or a crossed book.
+    auto is_consistent(const DepthSnapshot& snapshot) -> bool
+    {
+        const auto lower  = [](const SharedLevel& a, const SharedLevel& b) { return a.price < b.price; };
+        const auto higher = [](const SharedLevel& a, const SharedLevel& b) { return a.price > b.price; };
+        if (!std::is_sorted(snapshot.bids.begin(), snapshot.bids.end(), higher) || !std::is_sorted(snapshot.asks.begin(), snapshot.asks.end(), lower))
+        {
+            return false;
+        }
+        return snapshot.bids.empty() || snapshot.asks.empty() || snapshot.bids.front().price < snapshot.asks.front().price;
+    }
+
+    // Best of a few rounds, the flow is the same each time so the spread is scheduling noise.
+    auto measure(const CommandBuffer& flow, DepthView* view) -> float64
+    {
+        auto best = replay(flow, view);
+        for (usize i = 1; i < rounds; ++i)
+        {
+            best = std::min(best, replay(flow, view));
+        }
+        return best;
+    }
+}
+
+// Replays a flow without a depth view, with one, and with one read continuously by other threads, and reports the
+// writer overhead along with what the readers saw.
+auto main() -> int32
+{
+    WorkloadGenerator generator;
+    const auto        flow = generator.generate(commands);
+
+    const auto baseline = measure(flow, nullptr);
+
+    DepthView  view;
+    const auto idle = measure(flow, &view);
+
+    const usize         readers = std::max<usize>(std::thread::hardware_concurrency(), 2) - 1;
+    std::atomic<bool>   done    = false;
+    std::atomic<uint64> reads   = 0;
+    std::atomic<uint64> torn    = 0;
+
+    Vector<std::thread> threads;
+    for (usize i = 0; i < readers; ++i)
+    {
+        threads.emplace_back([&] {
+            DepthSnapshot snapshot;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                view.read(snapshot);
+                torn.fetch_add(is_consistent(snapshot) ? 0 : 1, std::memory_order_relaxed);
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    const auto busy = measure(flow, &view);
+    done.store(true, std::memory_order_relaxed);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    Log::info("{:>10} | {:>10} | {:>8} | {:>14} | {:>8} | {:>10} | {:>12} | {:>6}", "ns/cmd", "with view", "overhead", "with readers", "readers", "snapshots", "reads", "torn");
+    Log::info("{:>10.1f} | {:>10.1f} | {:>7.1f}% | {:>14.1f} | {:>8} | {:>10} | {:>12} | {:>6}", baseline, idle, 100.0 * (idle - baseline) / baseline, busy, readers,
+              view.version(), reads.load(), torn.load());
+}
@@ -0,0 +1,314 @@
+#include <log/log.hpp>
+#include <misc/random.hpp>
+#include <order_book/order_book.hpp>
+#include <order_book/workload.hpp>
+#include <profiling/perf_counters.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iterator>
+#include <string>
+#include <utility>
+
+using namespace flob;
+
+namespace
+{
+    constexpr usize rounds = 3;
+
+    constexpr usize    resting_orders = 1'000'000;
+    constexpr Price    resting_levels = 1'000;
+    constexpr usize    takers         = 200'000;
+    constexpr usize    sweeps         = 5'000;
+    constexpr Quantity iceberg_peak   = 10;  // Displayed slice of the resting icebergs, a tenth of their quantity
+    constexpr usize    replayed       = 2'000'000;
+    constexpr usize    snapshots      = 10'000;
+
+    struct Layout
+    {
+        const char*     name;
+        OrderBookConfig config;
+    };
+
+    struct Result
+    {
+        uint64     operations  = 0;
+        float64    nanoseconds = 0.0;
+        PerfSample sample;
+    };
+
+    // Times `run`, which returns the number of operations it did, with the counters around it.
+    template <typename Run>
+    auto measure(PerfCounters& counters, Run&& run) -> Result
+    {
+        Result result;
+
+        const auto start = std::chrono::steady_clock::now();
+        counters.start();
+        result.operations  = run();
+        result.sample      = counters.stop();
+        result.nanoseconds = std::chrono::duration<float64, std::nano>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    // Non-crossing GTC orders, alternately bids and asks spread over `resting_levels` per side.
+    auto resting_flow() -> CommandBuffer
+    {
+        CommandBuffer flow;
+        flow.reserve(resting_orders);
+        for (usize i = 0; i < resting_orders; ++i)
+        {
+            const auto side   = i % 2 == 0 ? Side::Buy : Side::Sell;
+            const auto offset = static_cast<Price>(i / 2 % resting_levels);
+            const auto price  = side == Side::Buy ? 100'000 - offset : 100'001 + offset;
+            flow.push_back(OrderCommand(0, OrderId(i + 1), price, 100, CommandType::Add, OrderType::GTC, side));
+        }
+        return flow;
+    }
+
+    auto fill(OrderBook& book, const CommandBuffer& flow) -> void
+    {
+        Trades trades;
+        for (const auto& command : flow)
+        {
+            trades.clear();
+            book.apply(command, trades);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------------
+    // Scenarios, each on a fresh book whose setup is not measured
+    //--------------------------------------------------------------------------------------------------------------
+
+    auto replay(const OrderBookConfig& config, PerfCounters& counters) -> Result
+    {
+        WorkloadGenerator generator;
+        const auto        flow = generator.generate(replayed);
+
+        OrderBook book(config);
+        return measure(counters, [&] {
+            fill(book, flow);
+            return flow.size();
+        });
+    }
+
+    auto add(const OrderBookConfig& config, PerfCounters& counters) -> Result
+    {
+        const auto flow = resting_flow();
+
+        OrderBook book(config);
+        return measure(counters, [&] {
+            fill(book, flow);
+            return flow.size();
+        });
+    }
+
+    auto cancel(const OrderBookConfig& config, PerfCounters& counters) -> Result
+    {
+        const auto flow = resting_flow();
+
+        // Cancelled in random order, so that lookups and level updates do not stream through memory.
+        Vector<OrderId> ids;
+        ids.reserve(flow.size());
+        for (const auto& command : flow)
+        {
+            ids.push_back(command.id);
+        }
+        Random random;
+        for (usize i = ids.size() - 1; i > 0; --i)
+        {
+            std::swap(ids[i], ids[random.uniform(i + 1)]);
+        }
+
+        OrderBook book(config);
+        fill(book, flow);
+        return measure(counters, [&] {
+            for (const auto id : ids)
+            {
+                book.cancel_order(id);
+            }
+            return ids.size();
+        });
+    }
+
+    auto match(const OrderBookConfig& config, PerfCounters& counters) -> Result
+    {
+        // Asks only, then buy IOCs that each take one to a few resting orders.
+        CommandBuffer flow;
+        for (const auto& command : resting_flow())
+        {
+            if (command.side == Side::Sell)
+            {
+                flow.push_back(command);
+            }
+        }
+
+        Random        random;
+        CommandBuffer orders;
+        orders.reserve(takers);
+        for (usize i = 0; i < takers; ++i)
+        {
+            const auto quantity = static_cast<Quantity>(random.range(50, 300));
+            orders.push_back(OrderCommand(0, OrderId(resting_orders + i + 1), 200'000, quantity, CommandType::Add, OrderType::IOC, Side::Buy));
+        }
+
+        OrderBook book(config);
+        fill(book, flow);
+        return measure(counters, [&] {
+            fill(book, orders);
+            return orders.size();
+        });
+    }
+
+    // Asks only, then buy IOCs that each take a few thousand lots, i.e. tens of resting orders. With `iceberg` the
+    // asks hold the same quantity at the same prices in icebergs, which the sweeps go through slice by slice.
+    auto sweep_asks(const OrderBookConfig& config, PerfCounters& counters, bool iceberg) -> Result
+    {
+        CommandBuffer flow;
+        for (auto command : resting_flow())
+        {
+            if (command.side == Side::Sell)
+            {
+                if (iceberg)
+                {
+                    command.flags         = OrderFlags::Iceberg;
+                    command.peak_quantity = iceberg_peak;
+                }
+                flow.push_back(command);
+            }
+        }
+
+        Random        random;
+        CommandBuffer orders;
+        orders.reserve(sweeps);
+        for (usize i = 0; i < sweeps; ++i)
+        {
+            const auto quantity = static_cast<Quantity>(random.range(2'000, 8'000));
+            orders.push_back(OrderCommand(0, OrderId(resting_orders + i + 1), 200'000, quantity, CommandType::Add, OrderType::IOC, Side::Buy));
+        }
+
+        OrderBook book(config);
+        fill(book, flow);
+        return measure(counters, [&] {
+            fill(book, orders);
+            return orders.size();
+        });
+    }
+
+    auto sweep(const OrderBookConfig& config, PerfCounters& counters) -> Result
+    {
+        return sweep_asks(config, counters, false);
+    }
+
+    auto iceberg(const OrderBookConfig& config, PerfCounters& counters) -> Result
+    {
+        return sweep_asks(config, counters, true);
+    }
+
+    auto infos(const OrderBookConfig& config, PerfCounters& counters) -> Result
+    {
+        OrderBook book(config);
+        fill(book, resting_flow());
+
+        OrderBookInfos infos;
+        return measure(counters, [&] {
+            for (usize i = 0; i < snapshots; ++i)
+            {
+                book.infos(infos);
+            }
+            return snapshots;
+        });
+    }
+
+    struct Scenario
+    {
+        const char* name;
+        Result (*run)(const OrderBookConfig&, PerfCounters&);
+    };
+
+    constexpr Scenario scenarios[] = {
+        {"replay", replay},
+        {"add", add},
+        {"cancel", cancel},
+        {"match", match},
+        {"sweep", sweep},
+        {"iceberg", iceberg},
+        {"infos", infos},
+    };
+
+    auto cell(float64 value) -> std::string
+    {
+        return std::isnan(value) ? std::string("-") : std::format("{:.2f}", value);
+    }
+}
+
+// Runs order book scenarios over a few book layouts and reports, per operation, the time along with the hardware
+// counters that explain it. Counters the machine does not expose are shown as '-'. Then reports the cost of iceberg
+// sweeps relative to the same sweeps over plain limit orders.
+auto main() -> int32
+{
+    Layout layouts[4] = {{"map", {}}, {"reserved", {}}, {"huge", {}}, {"depth-index", {}}};
+
+    layouts[1].config.order_capacity = resting_orders;
+    layouts[1].config.level_capacity = 4'096;
+
+    // Same capacity on pre-faulted transparent huge pages.
+    layouts[2].config       = layouts[1].config;
+    layouts[2].config.pages = PageConfig(HugePages::Transparent, true);
+
+    // Maintains a depth index covering the prices of every scenario, on top of the map levels.
+    layouts[3].config.depth_min_price = 0;
+    layouts[3].config.depth_max_price = 1 << 17;
+
+    for (auto& layout : layouts)
+    {
+        layout.config.manual_clock = true;
+    }
+
+    PerfCounters counters;
+    float64      sweep_ns[std::size(layouts)]   = {};
+    float64      iceberg_ns[std::size(layouts)] = {};
+
+    Log::info("{:>8} | {:>11} | {:>8} | {:>8} | {:>8} | {:>6} | {:>10} | {:>10} | {:>10} | {:>10} | {:>8}", "scenario", "layout", "ns/op", "cycles", "instr", "IPC",
+              "L1d miss", "LLC miss", "br miss", "dTLB miss", "faults");
+    for (const auto& scenario : scenarios)
+    {
+        for (usize l = 0; l < std::size(layouts); ++l)
+        {
+            const auto& layout = layouts[l];
+
+            // Best of a few rounds, the spread is scheduling noise.
+            auto best = scenario.run(layout.config, counters);
+            for (usize i = 1; i < rounds; ++i)
+            {
+                auto result = scenario.run(layout.config, counters);
+                best        = result.nanoseconds < best.nanoseconds ? result : best;
+            }
+
+            const auto& sample       = best.sample;
+            const auto  operations   = best.operations;
+            const auto  per_op       = best.nanoseconds / static_cast<float64>(operations);
+            const auto  cycles       = sample.per(PerfEvent::Cycles, operations);
+            const auto  instructions = sample.per(PerfEvent::Instructions, operations);
+            Log::info("{:>8} | {:>11} | {:>8.1f} | {:>8} | {:>8} | {:>6} | {:>10} | {:>10} | {:>10} | {:>10} | {:>8}", scenario.name, layout.name, per_op,
+                      cell(cycles), cell(instructions), cell(instructions / cycles), cell(sample.per(PerfEvent::L1DataMisses, operations)),
+                      cell(sample.per(PerfEvent::LlcMisses, operations)), cell(sample.per(PerfEvent::BranchMisses, operations)),
+                      cell(sample.per(PerfEvent::DtlbMisses, operations)), cell(sample.per(PerfEvent::PageFaults, operations)));
+
+            if (scenario.run == sweep)
+            {
+                sweep_ns[l] = per_op;
+            }
+            else if (scenario.run == iceberg)
+            {
+                iceberg_ns[l] = per_op;
+            }
+        }
+    }
+
+    for (usize l = 0; l < std::size(layouts); ++l)
+    {
+        Log::info("{:>11}: iceberg sweeps take {:.2f}x the time of limit sweeps", layouts[l].name, iceberg_ns[l] / sweep_ns[l]);
+    }
+}
@@ -0,0 +1,57 @@
+#include <log/log.hpp>
+#include <order_book/order_book.hpp>
+
+#include <chrono>
+
+#if defined(__GLIBC__)
+    #include <malloc.h>
+#endif
+
+using namespace flob;
+
+namespace
+{
+    // Bytes currently handed out by malloc, its own mappings of large blocks included. Memory mapped directly, e.g. the
+    // huge page chunks of a node pool, is not seen.
+    auto heap_in_use() -> usize
+    {
+#if defined(__GLIBC__)
+        const auto info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+#else
+        return 0;
+#endif
+    }
+}
+
+// Fills a book with non-crossing GTC orders and reports the heap held per resting order, everything included: order
+// storage, the id index and the price levels. The default page config keeps all of it on the heap.
+auto main() -> int32
+{
+#if !defined(__GLIBC__)
+    Log::warn("Heap usage is only measured with glibc.");
+#endif
+
+    constexpr usize orders = 1'000'000;
+    constexpr Price levels = 1'000;
+
+    OrderBookConfig config;
+    config.manual_clock = true;
+
+    const auto before = heap_in_use();
+    OrderBook  book(config);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (usize i = 0; i < orders; ++i)
+    {
+        const auto side   = i % 2 == 0 ? Side::Buy : Side::Sell;
+        const auto offset = static_cast<Price>(i / 2 % levels);
+        const auto price  = side == Side::Buy ? 100'000 - offset : 100'001 + offset;
+        book.add_order(make_ref<Order>(OrderId(i + 1), OrderType::GTC, side, price, 100));
+    }
+    const auto elapsed = std::chrono::duration<float64>(std::chrono::steady_clock::now() - start).count();
+
+    const auto bytes = static_cast<float64>(heap_in_use() - before) / static_cast<float64>(book.size());
+    Log::info("{:>10} | {:>12} | {:>10}", "resting", "adds/s", "bytes/order");
+    Log::info("{:>10} | {:>12.0f} | {:>10.1f}", book.size(), static_cast<float64>(orders) / elapsed, bytes);
+}
@@ -0,0 +1,89 @@
+#include <log/log.hpp>
+#include <market_data/shared_book.hpp>
+#include <order_book/order_book.hpp>
+#include <order_book/workload.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+using namespace flob;
+
+namespace
+{
+    constexpr usize commands = 2'000'000;
+    constexpr usize depth    = 10;
+
+    auto replay(const CommandBuffer& flow, BookPublisher* publisher) -> float64
+    {
+        OrderBookConfig config;
+        config.manual_clock = true;
+        config.publisher    = publisher;
+        OrderBook book(config);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& command : flow)
+        {
+            book.apply(command);
+        }
+        return std::chrono::duration<float64, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<float64>(flow.size());
+    }
+
+    // A snapshot torn between two updates would show levels out of order or a crossed book.
+    auto is_consistent(const SharedBookSnapshot& snapshot) -> bool
+    {
+        for (usize i = 1; i < snapshot.bid_count; ++i)
+        {
+            if (snapshot.bids[i].price >= snapshot.bids[i - 1].price)
+            {
+                return false;
+            }
+        }
+        for (usize i = 1; i < snapshot.ask_count; ++i)
+        {
+            if (snapshot.asks[i].price <= snapshot.asks[i - 1].price)
+            {
+                return false;
+            }
+        }
+        return snapshot.bid_count == 0 || snapshot.ask_count == 0 || snapshot.bids[0].price < snapshot.asks[0].price;
+    }
+}
+
+// Replays the same flow with and without a shared memory publisher while another thread reads snapshots as fast as
+// it can, and reports the cost on the matcher along with what the reader saw.
+auto main() -> int32
+{
+    WorkloadGenerator generator;
+    const auto        flow = generator.generate(commands);
+
+    const auto baseline = replay(flow, nullptr);
+
+    auto publisher = BookPublisher::create("/flob.bench", depth);
+    auto reader    = BookReader::open("/flob.bench");
+    if (publisher.empty() || reader.empty())
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::atomic<bool> done  = false;
+    uint64            reads = 0;
+    uint64            torn  = 0;
+    std::thread       thread([&] {
+        SharedBookSnapshot snapshot;
+        while (!done.load(std::memory_order_relaxed))
+        {
+            reader.read(snapshot);
+            torn += is_consistent(snapshot) ? 0 : 1;
+            ++reads;
+        }
+    });
+
+    const auto published = replay(flow, &publisher);
+    done.store(true, std::memory_order_relaxed);
+    thread.join();
+
+    Log::info("{:>12} | {:>12} | {:>10} | {:>12} | {:>6}", "ns/cmd", "publishing", "updates", "reads", "torn");
+    Log::info("{:>12.1f} | {:>12.1f} | {:>10} | {:>12} | {:>6}", baseline, published, reader.sequence() / 2, reads, torn);
+}
@@ -0,0 +1,47 @@
+#include <log/log.hpp>
+#include <simulation/agents.hpp>
+
+#include <chrono>
+
+using namespace flob;
+
+// Runs a market of noise traders, market makers and takers with uneven latencies and reports the event rate of the
+// kernel along with what the agents traded.
+auto main() -> int32
+{
+    constexpr usize noise_traders = 8;
+    constexpr usize market_makers = 2;
+    constexpr usize takers        = 4;
+    constexpr auto  duration      = std::chrono::seconds(10);
+
+    SimulatorConfig config;
+    config.book.session = new_york_session;
+    MarketSimulator simulator(config);
+
+    for (usize i = 0; i < noise_traders; ++i)
+    {
+        const AgentLatency latency(std::chrono::microseconds(40 + 20 * i), std::chrono::microseconds(10 + 5 * i));
+        simulator.add_agent(latency, [](MarketSimulator& simulator, AgentId agent) { return noise_trader(simulator, agent, {}); });
+    }
+    for (usize i = 0; i < market_makers; ++i)
+    {
+        const AgentLatency latency(std::chrono::microseconds(5 + 5 * i), std::chrono::microseconds(2 + i));
+        simulator.add_agent(latency, [](MarketSimulator& simulator, AgentId agent) { return market_maker(simulator, agent, {}); });
+    }
+    for (usize i = 0; i < takers; ++i)
+    {
+        simulator.add_agent({}, [](MarketSimulator& simulator, AgentId agent) { return taker(simulator, agent, {}); });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    simulator.run(duration);
+    const auto seconds = std::chrono::duration<float64>(std::chrono::steady_clock::now() - start).count();
+
+    const auto& stats = simulator.stats();
+    Log::info("Simulated {} s in {:.2f} s: {} events ({:.2f} M/s), {} orders, {} trades, {} volume", duration.count(), seconds, stats.events,
+              static_cast<float64>(stats.events) / seconds / 1e6, stats.orders, stats.trades, stats.volume);
+    for (AgentId agent = noise_traders; agent < simulator.agent_count(); ++agent)
+    {
+        Log::info("{} {:>2} position {:>6}", agent < noise_traders + market_makers ? "maker" : "taker", agent, simulator.position(agent));
+    }
+}
@@ -1,6 +1,6 @@
 #include <log/log.hpp>
 #include <order_book/order_book.hpp>
-#include <order_book/order_feeder.hpp>
+#include <order_book/workload.hpp>
 
 #include <chrono>
 
@@ -30,20 +30,23 @@ auto main() -> int32
 
     OrderBook order_book(cfg);
 
-    OrderFeeder feeder;
+    // Pre-generate the flow so that only the book is timed
+    constexpr uint64 N = 1'000'000;
 
-    // Generate many orders
-    constexpr uint64 N = 500'000;
+    WorkloadGenerator generator;
+    const auto        commands = generator.generate(N);
+
+    usize trades = 0;
 
     const auto t0 = Clock::now();
-    for (uint64 i = 0; i < N; ++i)
+    for (const auto& command : commands)
     {
-        order_book.add_order(feeder.next());
+        trades += order_book.apply(command).size();
     }
     const auto t1 = Clock::now();
     const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
 
-    Log::info("Submitted {} orders in {} ms", N, ms);
+    Log::info("Applied {} commands ({} trades) in {} ms", N, trades, ms);
 
     OrderBookInfos infos = order_book.infos();
     print_order_book(infos);
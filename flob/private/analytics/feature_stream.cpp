@@ -0,0 +1,155 @@
+#include "analytics/feature_stream.hpp"
+
+#include "log/log.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+namespace flob
+{
+    namespace
+    {
+        constexpr auto column_count = static_cast<usize>(FeatureColumn::Count);
+
+        // Change of the bid queue minus change of the ask queue. A better price counts the whole new queue, a worse one
+        // the whole old queue, and an unchanged price the difference.
+        auto flow_between(const TopOfBook& before, const TopOfBook& after) noexcept -> int64
+        {
+            // An empty bid side sits below every price rather than above it.
+            const auto bid_before = before.bid_price == invalid_price ? 0 : before.bid_price;
+            const auto bid_after  = after.bid_price == invalid_price ? 0 : after.bid_price;
+
+            int64 flow = 0;
+            flow += bid_after >= bid_before ? after.bid_quantity : 0;
+            flow -= bid_after <= bid_before ? before.bid_quantity : 0;
+            flow -= after.ask_price <= before.ask_price ? after.ask_quantity : 0;
+            flow += after.ask_price >= before.ask_price ? before.ask_quantity : 0;
+            return flow;
+        }
+
+        auto to_float(Price price) noexcept -> float64
+        {
+            return price == invalid_price ? std::numeric_limits<float64>::quiet_NaN() : static_cast<float64>(price);
+        }
+    }
+
+    FeatureStream::FeatureStream(const FeatureConfig& config)
+        : _config(config)
+    {
+        if (_config.capacity == 0)
+        {
+            return;
+        }
+
+        _buffer = MappedFile::map(_config.path, sizeof(FeatureHeader) + column_count * _config.capacity * sizeof(float64));
+        if (_buffer.empty())
+        {
+            Log::error("Feature buffer unavailable, features will not be sampled.");
+            return;
+        }
+
+        _header  = reinterpret_cast<FeatureHeader*>(_buffer.data());
+        _columns = _buffer.data() + sizeof(FeatureHeader);
+
+        std::memcpy(_header->magic, "FLOBFEAT", sizeof(_header->magic));
+        _header->version      = version;
+        _header->column_count = static_cast<uint32>(column_count);
+        _header->capacity     = _config.capacity;
+        _header->count        = 0;
+    }
+
+    auto FeatureStream::on_book(TimePoint time, const TopOfBook& top) -> void
+    {
+        if (_config.sampling == FeatureSampling::Bucket)
+        {
+            const auto bucket = static_cast<int64>(time.time_since_epoch() / _config.bucket);
+            if (bucket != _bucket)
+            {
+                flush();
+                _bucket = bucket;
+            }
+
+            const auto flow = flow_between(_top, top);
+            _top            = top;
+            _order_flow += flow;
+            _bucket_order_flow += flow;
+            _bucket_pending = true;
+            return;
+        }
+
+        if (top == _top)
+        {
+            // Nothing visible changed, the event carries no order flow either.
+            return;
+        }
+
+        const auto flow = flow_between(_top, top);
+        _top            = top;
+        _order_flow += flow;
+        append(time, flow);
+    }
+
+    auto FeatureStream::flush() -> void
+    {
+        if (!_bucket_pending)
+        {
+            return;
+        }
+
+        append(TimePoint(std::chrono::duration_cast<TimePoint::duration>(_bucket * _config.bucket)), _bucket_order_flow);
+        _bucket_order_flow = 0;
+        _bucket_pending    = false;
+        _buffer.sync();
+    }
+
+    auto FeatureStream::row(uint64 index) const noexcept -> FeatureRow
+    {
+        ensure(index < _count && _count - index <= size(), "Row no longer held");
+
+        const auto slot = index % _config.capacity;
+        const auto time = std::chrono::nanoseconds(column<int64>(FeatureColumn::Time)[slot]);
+
+        const auto to_price = [](float64 value) { return std::isnan(value) ? invalid_price : static_cast<Price>(value); };
+
+        TopOfBook top;
+        top.bid_price    = to_price(column<float64>(FeatureColumn::BidPrice)[slot]);
+        top.bid_quantity = static_cast<Quantity>(column<float64>(FeatureColumn::BidQuantity)[slot]);
+        top.ask_price    = to_price(column<float64>(FeatureColumn::AskPrice)[slot]);
+        top.ask_quantity = static_cast<Quantity>(column<float64>(FeatureColumn::AskQuantity)[slot]);
+
+        return FeatureRow(TimePoint(std::chrono::duration_cast<TimePoint::duration>(time)), top, static_cast<int64>(column<float64>(FeatureColumn::OrderFlow)[slot]));
+    }
+
+    auto FeatureStream::append(TimePoint time, int64 flow) -> void
+    {
+        if (_buffer.empty())
+        {
+            return;
+        }
+
+        const auto slot = _count % _config.capacity;
+
+        column<int64>(FeatureColumn::Time)[slot]          = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        column<float64>(FeatureColumn::BidPrice)[slot]    = to_float(_top.bid_price);
+        column<float64>(FeatureColumn::BidQuantity)[slot] = _top.bid_quantity;
+        column<float64>(FeatureColumn::AskPrice)[slot]    = to_float(_top.ask_price);
+        column<float64>(FeatureColumn::AskQuantity)[slot] = _top.ask_quantity;
+        column<float64>(FeatureColumn::Spread)[slot]      = _top.spread();
+        column<float64>(FeatureColumn::MidPrice)[slot]    = _top.mid_price();
+        column<float64>(FeatureColumn::MicroPrice)[slot]  = _top.micro_price();
+        column<float64>(FeatureColumn::Imbalance)[slot]   = _top.imbalance();
+        column<float64>(FeatureColumn::OrderFlow)[slot]   = static_cast<float64>(flow);
+
+        // Readers in other processes trust every row below the published count.
+        ++_count;
+        std::atomic_ref(_header->count).store(_count, std::memory_order_release);
+    }
+
+    template <typename T>
+    auto FeatureStream::column(FeatureColumn column) const noexcept -> T*
+    {
+        static_assert(sizeof(T) == sizeof(float64));
+        return reinterpret_cast<T*>(_columns + static_cast<usize>(column) * _config.capacity * sizeof(T));
+    }
+}
@@ -0,0 +1,126 @@
+#include "analytics/trade_tape.hpp"
+
+#include "log/log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace flob
+{
+    namespace
+    {
+        constexpr usize column_count = static_cast<usize>(TapeColumn::Count);
+
+        constexpr usize column_widths[column_count] = {
+            sizeof(uint64), sizeof(int64), sizeof(uint64), sizeof(uint64), sizeof(Price), sizeof(Quantity), sizeof(Aggressor),
+        };
+
+        // Offset of a column within its block, every column before it takes `rows` values.
+        constexpr auto column_offset(TapeColumn column, usize rows) noexcept -> usize
+        {
+            usize offset = 0;
+            for (usize i = 0; i < static_cast<usize>(column); ++i)
+            {
+                offset += column_widths[i] * rows;
+            }
+            return offset;
+        }
+    }
+
+    // A multiple of 8 rows keeps every column of every block aligned to its width.
+    TradeTape::TradeTape(const TradeTapeConfig& config)
+        : _block_rows((std::max<usize>(config.block_rows, 1) + 7) / 8 * 8)
+    {
+        _blocks.reserve(config.reserved_blocks);
+        for (usize i = 0; i < config.reserved_blocks; ++i)
+        {
+            if (!add_block())
+            {
+                break;
+            }
+        }
+    }
+
+    auto TradeTape::append(const Trade& trade, Price price, Aggressor aggressor, TimePoint time) -> void
+    {
+        const auto block = static_cast<usize>(_count / _block_rows);
+        if (block == _blocks.size() && !add_block())
+        {
+            return;
+        }
+
+        const auto row = static_cast<usize>(_count % _block_rows);
+
+        column<uint64>(block, TapeColumn::Sequence)[row]     = _count;
+        column<int64>(block, TapeColumn::Time)[row]          = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        column<uint64>(block, TapeColumn::BidId)[row]        = static_cast<uint64>(trade.bid_id);
+        column<uint64>(block, TapeColumn::AskId)[row]        = static_cast<uint64>(trade.ask_id);
+        column<Price>(block, TapeColumn::Price)[row]         = price;
+        column<Quantity>(block, TapeColumn::Quantity)[row]   = trade.quantity;
+        column<Aggressor>(block, TapeColumn::Aggressor)[row] = aggressor;
+        ++_count;
+    }
+
+    auto TradeTape::record(uint64 sequence) const noexcept -> TapeRecord
+    {
+        ensure(sequence < _count, "Trade not on the tape");
+
+        const auto block = static_cast<usize>(sequence / _block_rows);
+        const auto row   = static_cast<usize>(sequence % _block_rows);
+        const auto time  = std::chrono::nanoseconds(column<int64>(block, TapeColumn::Time)[row]);
+
+        return TapeRecord(column<uint64>(block, TapeColumn::Sequence)[row], TimePoint(std::chrono::duration_cast<TimePoint::duration>(time)),
+                          OrderId(column<uint64>(block, TapeColumn::BidId)[row]), OrderId(column<uint64>(block, TapeColumn::AskId)[row]),
+                          column<Price>(block, TapeColumn::Price)[row], column<Quantity>(block, TapeColumn::Quantity)[row],
+                          column<Aggressor>(block, TapeColumn::Aggressor)[row]);
+    }
+
+    auto TradeTape::write(std::string_view path) const -> bool
+    {
+        // Blocks past the last trade are left out, a partly filled block is written whole.
+        const auto blocks = static_cast<usize>((_count + _block_rows - 1) / _block_rows);
+        const auto size   = block_size(_block_rows);
+
+        auto file = MappedFile::map(path, sizeof(TapeHeader) + blocks * size);
+        if (file.empty() || !file.is_file())
+        {
+            Log::error("Trade tape could not be written to {}.", path);
+            return false;
+        }
+
+        auto* header = reinterpret_cast<TapeHeader*>(file.data());
+        std::memcpy(header->magic, "FLOBTAPE", sizeof(header->magic));
+        header->version      = version;
+        header->column_count = static_cast<uint32>(column_count);
+        header->block_rows   = _block_rows;
+        header->block_size   = size;
+        header->count        = _count;
+
+        for (usize i = 0; i < blocks; ++i)
+        {
+            std::memcpy(file.data() + sizeof(TapeHeader) + i * size, _blocks[i].data(), size);
+        }
+        file.sync();
+        return true;
+    }
+
+    auto TradeTape::add_block() -> bool
+    {
+        auto block = MappedFile::map({}, block_size(_block_rows));
+        if (block.empty())
+        {
+            Log::error("Trade tape block unavailable, trades will not be recorded.");
+            return false;
+        }
+
+        _blocks.push_back(std::move(block));
+        return true;
+    }
+
+    template <typename T>
+    auto TradeTape::column(usize block, TapeColumn column) const noexcept -> T*
+    {
+        return reinterpret_cast<T*>(const_cast<std::byte*>(_blocks[block].data()) + column_offset(column, _block_rows));
+    }
+}
@@ -0,0 +1,171 @@
+#include "concurrency/work_stealing_pool.hpp"
+
+#include "debug/ensure.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace flob
+{
+    namespace
+    {
+        constexpr auto pack(uint64 begin, uint64 end) noexcept -> uint64
+        {
+            return begin << 32 | end;
+        }
+
+        constexpr auto begin_of(uint64 range) noexcept -> uint64
+        {
+            return range >> 32;
+        }
+
+        constexpr auto end_of(uint64 range) noexcept -> uint64
+        {
+            return range & 0xFFFF'FFFF;
+        }
+    }
+
+    WorkStealingPool::WorkStealingPool(usize workers)
+        : _size(std::max<usize>(workers, 1))
+        , _workers(std::make_unique<Worker[]>(_size))
+    {
+        _threads.reserve(_size);
+        for (usize worker = 0; worker < _size; ++worker)
+        {
+            _threads.emplace_back([this, worker] { work(worker); });
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        _stop.store(true, std::memory_order_relaxed);
+        _generation.fetch_add(1, std::memory_order_release);
+        _generation.notify_all();
+
+        for (auto& thread : _threads)
+        {
+            thread.join();
+        }
+    }
+
+    auto WorkStealingPool::run(usize count, Invoke invoke, void* body) -> PoolStats
+    {
+        ensure(count <= std::numeric_limits<uint32>::max(), "Too many tasks for a single range");
+
+        // Equal slices, the first `count % size` workers take one more.
+        usize begin = 0;
+        for (usize worker = 0; worker < _size; ++worker)
+        {
+            const auto end = begin + count / _size + (worker < count % _size ? 1 : 0);
+
+            auto& state = _workers[worker];
+            state.range.store(pack(begin, end), std::memory_order_relaxed);
+            state.tasks  = 0;
+            state.steals = 0;
+            state.busy   = 0;
+            begin        = end;
+        }
+
+        _invoke = invoke;
+        _body   = body;
+        _running.store(_size, std::memory_order_relaxed);
+
+        const auto start = std::chrono::steady_clock::now();
+        _generation.fetch_add(1, std::memory_order_release);
+        _generation.notify_all();
+
+        for (auto running = _running.load(std::memory_order_acquire); running != 0; running = _running.load(std::memory_order_acquire))
+        {
+            _running.wait(running, std::memory_order_acquire);
+        }
+        const auto wall = std::chrono::steady_clock::now() - start;
+
+        PoolStats stats(std::chrono::duration_cast<std::chrono::nanoseconds>(wall), std::chrono::nanoseconds::zero(), 0, 0, _size);
+        for (usize worker = 0; worker < _size; ++worker)
+        {
+            const auto& state = _workers[worker];
+            stats.busy += std::chrono::nanoseconds(state.busy);
+            stats.tasks += state.tasks;
+            stats.steals += state.steals;
+        }
+        return stats;
+    }
+
+    auto WorkStealingPool::work(usize worker) -> void
+    {
+        uint64 generation = 0;
+        while (true)
+        {
+            _generation.wait(generation, std::memory_order_acquire);
+            generation = _generation.load(std::memory_order_acquire);
+            if (_stop.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            drain(worker);
+            if (_running.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                _running.notify_all();
+            }
+        }
+    }
+
+    auto WorkStealingPool::drain(usize worker) -> void
+    {
+        auto& state = _workers[worker];
+
+        usize index;
+        while (pop(worker, index) || steal(worker, index))
+        {
+            const auto start = std::chrono::steady_clock::now();
+            _invoke(_body, worker, index);
+            state.busy += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            ++state.tasks;
+        }
+    }
+
+    auto WorkStealingPool::pop(usize worker, usize& index) noexcept -> bool
+    {
+        auto& slice = _workers[worker].range;
+
+        auto range = slice.load(std::memory_order_acquire);
+        while (begin_of(range) < end_of(range))
+        {
+            if (slice.compare_exchange_weak(range, pack(begin_of(range) + 1, end_of(range)), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                index = begin_of(range);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto WorkStealingPool::steal(usize thief, usize& index) noexcept -> bool
+    {
+        // Slices only shrink, and the one a thief refills is empty and made of indices never seen in it before, so a
+        // compare-and-swap cannot succeed on a stale slice.
+        for (usize offset = 1; offset < _size; ++offset)
+        {
+            auto& victim = _workers[(thief + offset) % _size].range;
+
+            auto range = victim.load(std::memory_order_acquire);
+            while (begin_of(range) < end_of(range))
+            {
+                const auto begin = begin_of(range);
+                const auto end   = end_of(range);
+                const auto split = end - (end - begin + 1) / 2;
+                if (victim.compare_exchange_weak(range, pack(begin, split), std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    auto& state = _workers[thief];
+                    state.range.store(pack(split + 1, end), std::memory_order_release);
+                    ++state.steals;
+
+                    index = split;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
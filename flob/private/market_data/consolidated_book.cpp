@@ -0,0 +1,182 @@
+#include "market_data/consolidated_book.hpp"
+
+#include "debug/ensure.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace flob
+{
+    namespace
+    {
+        constexpr auto no_venue = std::numeric_limits<uint32>::max();
+
+        constexpr auto is_better(Side side, Price a, Price b) noexcept -> bool
+        {
+            return side == Side::Buy ? a > b : a < b;
+        }
+
+        // A match of the tournament: the better price, or both when they quote the same one.
+        constexpr auto play(Side side, const ConsolidatedLevel& a, const ConsolidatedLevel& b) noexcept -> ConsolidatedLevel
+        {
+            if (b.venues == 0)
+            {
+                return a;
+            }
+            if (a.venues == 0)
+            {
+                return b;
+            }
+            if (a.price == b.price)
+            {
+                return ConsolidatedLevel(a.price, a.quantity + b.quantity, a.venues + b.venues);
+            }
+            return is_better(side, a.price, b.price) ? a : b;
+        }
+    }
+
+    ConsolidatedBook::Venue::Venue(NodePool* nodes)
+        : bids(nodes)
+        , asks(nodes)
+    {}
+
+    ConsolidatedBook::ConsolidatedBook(usize venues)
+        : _nodes(std::make_unique<NodePool>())
+        , _leaves(std::bit_ceil(std::max<usize>(venues, 1)))
+        , _bids(_leaves * 2, ConsolidatedLevel())
+        , _asks(_leaves * 2, ConsolidatedLevel())
+        , _winners(_leaves * 2, no_venue)
+    {
+        _venues.reserve(venues);
+        for (usize i = 0; i < venues; ++i)
+        {
+            _venues.emplace_back(_nodes.get());
+        }
+        _bid_cursors.resize(venues);
+        _ask_cursors.resize(venues);
+    }
+
+    auto ConsolidatedBook::update(usize venue, Side side, Price price, int64 quantity) -> void
+    {
+        ensure(venue < venues(), "Venue out of range");
+        if (side == Side::Buy)
+        {
+            update_levels(_venues[venue].bids, _bids, venue, side, price, quantity);
+        }
+        else
+        {
+            update_levels(_venues[venue].asks, _asks, venue, side, price, quantity);
+        }
+    }
+
+    auto ConsolidatedBook::depth(Side side, usize count, Vector<ConsolidatedLevel>& levels) const -> void
+    {
+        if (side == Side::Buy)
+        {
+            merge(&Venue::bids, _bid_cursors, side, count, levels);
+        }
+        else
+        {
+            merge(&Venue::asks, _ask_cursors, side, count, levels);
+        }
+    }
+
+    template <typename Levels>
+    auto ConsolidatedBook::update_levels(Levels& levels, Vector<ConsolidatedLevel>& tree, usize venue, Side side, Price price, int64 quantity) -> void
+    {
+        const auto it = levels.try_emplace(price, 0).first;
+        it->second    = static_cast<Quantity>(it->second + quantity);
+
+        const auto best = it == levels.begin();
+        if (it->second == 0)
+        {
+            levels.erase(it);
+        }
+
+        // Levels behind the best one of the venue do not take part in the tournament.
+        if (!best)
+        {
+            return;
+        }
+
+        auto node  = _leaves + venue;
+        tree[node] = levels.empty() ? ConsolidatedLevel() : ConsolidatedLevel(levels.begin()->first, levels.begin()->second, 1);
+
+        // Replays the matches on the way to the root, and stops at the first one whose result did not change.
+        for (node /= 2; node > 0; node /= 2)
+        {
+            const auto result = play(side, tree[2 * node], tree[2 * node + 1]);
+            if (result == tree[node])
+            {
+                break;
+            }
+            tree[node] = result;
+        }
+    }
+
+    template <typename Levels, typename Cursor>
+    auto ConsolidatedBook::merge(Levels Venue::* side_levels, Vector<Cursor>& cursors, Side side, usize count, Vector<ConsolidatedLevel>& levels) const -> void
+    {
+        levels.clear();
+
+        // The winner of a match is the venue whose cursor has the better price, exhausted venues and padding leaves
+        // never win.
+        const auto exhausted = [&](uint32 venue) { return venue == no_venue || cursors[venue] == (_venues[venue].*side_levels).end(); };
+        const auto match     = [&](uint32 a, uint32 b) {
+            if (exhausted(b))
+            {
+                return a;
+            }
+            if (exhausted(a))
+            {
+                return b;
+            }
+            return is_better(side, cursors[b]->first, cursors[a]->first) ? b : a;
+        };
+        const auto replay = [&](usize node) {
+            for (node /= 2; node > 0; node /= 2)
+            {
+                _winners[node] = match(_winners[2 * node], _winners[2 * node + 1]);
+            }
+        };
+
+        for (usize venue = 0; venue < _leaves; ++venue)
+        {
+            auto& leaf = _winners[_leaves + venue];
+            leaf       = no_venue;
+            if (venue < _venues.size())
+            {
+                cursors[venue] = (_venues[venue].*side_levels).begin();
+                leaf           = static_cast<uint32>(venue);
+            }
+        }
+        for (auto node = _leaves - 1; node > 0; --node)
+        {
+            _winners[node] = match(_winners[2 * node], _winners[2 * node + 1]);
+        }
+
+        // Venues quoting the same price come out one after the other and are summed into the same level.
+        while (!exhausted(_winners[1]))
+        {
+            const auto venue           = _winners[1];
+            const auto [price, amount] = *cursors[venue];
+            if (!levels.empty() && levels.back().price == price)
+            {
+                levels.back().quantity += amount;
+                ++levels.back().venues;
+            }
+            else if (count != 0 && levels.size() == count)
+            {
+                break;
+            }
+            else
+            {
+                levels.push_back(ConsolidatedLevel(price, amount, 1));
+            }
+
+            ++cursors[venue];
+            replay(_leaves + venue);
+        }
+    }
+}
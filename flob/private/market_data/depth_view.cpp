@@ -0,0 +1,81 @@
+#include "market_data/depth_view.hpp"
+
+#include <algorithm>
+
+namespace flob
+{
+    DepthView::DepthView(const DepthViewConfig& config)
+        : _config(config)
+        , _current(0)
+        , _version(0)
+    {
+        // Two slots at least: the current one and one to fill.
+        _config.slots = std::max<usize>(_config.slots, 2);
+        _slots        = std::make_unique<Slot[]>(_config.slots);
+
+        // Bounded snapshots are filled without allocating.
+        for (usize i = 0; i < _config.slots && _config.levels > 0; ++i)
+        {
+            _slots[i].snapshot.bids.reserve(_config.levels);
+            _slots[i].snapshot.asks.reserve(_config.levels);
+        }
+    }
+
+    auto DepthView::version() const noexcept -> uint64
+    {
+        return _version.load(std::memory_order_acquire);
+    }
+
+    auto DepthView::read(DepthSnapshot& snapshot) const -> void
+    {
+        // The pin and the check that follows are sequentially consistent, like the writer's check of the counter
+        // after it moved the current slot away: either the writer sees the pin, or the reader sees the move.
+        while (true)
+        {
+            const auto index = _current.load(std::memory_order_seq_cst);
+            auto&      slot  = _slots[index];
+            slot.readers.fetch_add(1, std::memory_order_seq_cst);
+            if (_current.load(std::memory_order_seq_cst) == index)
+            {
+                snapshot = slot.snapshot;
+                slot.readers.fetch_sub(1, std::memory_order_release);
+                return;
+            }
+            slot.readers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    auto DepthView::due(TimePoint now) noexcept -> bool
+    {
+        ++_operations;
+        return _operations >= _config.operations || now - _published >= _config.interval;
+    }
+
+    auto DepthView::begin_update() noexcept -> DepthSnapshot*
+    {
+        const auto current = _current.load(std::memory_order_relaxed);
+        for (usize i = 1; i < _config.slots; ++i)
+        {
+            const auto index = (current + i) % _config.slots;
+            if (_slots[index].readers.load(std::memory_order_seq_cst) == 0)
+            {
+                _next = index;
+                return &_slots[index].snapshot;
+            }
+        }
+        return nullptr;
+    }
+
+    auto DepthView::end_update(TimePoint now) noexcept -> void
+    {
+        const auto version  = _version.load(std::memory_order_relaxed) + 1;
+        auto&      snapshot = _slots[_next].snapshot;
+        snapshot.version    = version;
+        snapshot.time       = now;
+
+        _current.store(_next, std::memory_order_seq_cst);
+        _version.store(version, std::memory_order_release);
+        _operations = 0;
+        _published  = now;
+    }
+}
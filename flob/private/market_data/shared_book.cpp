@@ -0,0 +1,413 @@
+#include "market_data/shared_book.hpp"
+
+#include "log/log.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if !defined(_WIN32)
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace flob
+{
+    namespace
+    {
+        constexpr char magic[8] = {'F', 'L', 'O', 'B', 'B', 'O', 'O', 'K'};
+
+        // Word indices in the region, the levels start with the bids.
+        constexpr usize time_word       = 0;
+        constexpr usize last_price_word = 1;
+        constexpr usize level_word      = 2;
+
+        constexpr auto word_count(usize depth) noexcept -> usize
+        {
+            return level_word + 2 * depth;
+        }
+
+        constexpr auto region_size(usize depth) noexcept -> usize
+        {
+            return sizeof(SharedBookHeader) + sizeof(uint64) * (1 + word_count(depth));
+        }
+
+        constexpr auto pack(SharedLevel level) noexcept -> uint64
+        {
+            return static_cast<uint64>(level.price) << 32 | level.quantity;
+        }
+
+        constexpr auto unpack(uint64 word) noexcept -> SharedLevel
+        {
+            return SharedLevel(static_cast<Price>(word >> 32), static_cast<Quantity>(word));
+        }
+
+        // POSIX names are a single component starting with a slash.
+        auto region_name(std::string_view name) -> std::string
+        {
+            return name.starts_with('/') ? std::string(name) : "/" + std::string(name);
+        }
+
+        static_assert(max_shared_depth <= 32, "The dirty mask of a commit holds 32 levels per side");
+    }
+
+    //==============================================================================================
+    // class : BookPublisher
+    //==============================================================================================
+
+    BookPublisher::BookPublisher(std::string name, std::byte* data, usize size, usize depth) noexcept
+        : _name(std::move(name))
+        , _data(data)
+        , _size(size)
+        , _depth(depth)
+        , _sequence(reinterpret_cast<std::atomic<uint64>*>(data + sizeof(SharedBookHeader)))
+        , _words(_sequence + 1)
+        , _staged(2 * depth)
+        , _published(word_count(depth), pack(SharedLevel()))
+    {
+        _published[time_word]       = 0;
+        _published[last_price_word] = invalid_price;
+    }
+
+    BookPublisher::~BookPublisher() noexcept
+    {
+        release();
+    }
+
+    BookPublisher::BookPublisher(BookPublisher&& other) noexcept
+        : _name(std::move(other._name))
+        , _data(std::exchange(other._data, nullptr))
+        , _size(std::exchange(other._size, 0))
+        , _depth(std::exchange(other._depth, 0))
+        , _sequence(std::exchange(other._sequence, nullptr))
+        , _words(std::exchange(other._words, nullptr))
+        , _staged(std::move(other._staged))
+        , _published(std::move(other._published))
+    {}
+
+    auto BookPublisher::operator=(BookPublisher&& other) noexcept -> BookPublisher&
+    {
+        if (this != &other)
+        {
+            release();
+            _name      = std::move(other._name);
+            _data      = std::exchange(other._data, nullptr);
+            _size      = std::exchange(other._size, 0);
+            _depth     = std::exchange(other._depth, 0);
+            _sequence  = std::exchange(other._sequence, nullptr);
+            _words     = std::exchange(other._words, nullptr);
+            _staged    = std::move(other._staged);
+            _published = std::move(other._published);
+        }
+        return *this;
+    }
+
+    auto BookPublisher::stage(Side side) noexcept -> std::span<SharedLevel>
+    {
+        return std::span<SharedLevel>(_staged.data() + (side == Side::Buy ? 0 : _depth), _depth);
+    }
+
+    auto BookPublisher::boundary(Side side) const noexcept -> Price
+    {
+        const auto& last = _staged[side == Side::Buy ? _depth - 1 : 2 * _depth - 1];
+        return last.quantity == 0 ? invalid_price : last.price;
+    }
+
+    auto BookPublisher::commit(TimePoint time, Price last_price) noexcept -> bool
+    {
+        // Diffing against the private copy first keeps the shared cache lines untouched for updates away from the top.
+        uint64 dirty = 0;
+        for (usize i = 0; i < _depth; ++i)
+        {
+            const auto bid = pack(_staged[i]);
+            const auto ask = pack(_staged[_depth + i]);
+            if (bid != _published[level_word + i])
+            {
+                _published[level_word + i] = bid;
+                dirty |= uint64(1) << i;
+            }
+            if (ask != _published[level_word + _depth + i])
+            {
+                _published[level_word + _depth + i] = ask;
+                dirty |= uint64(1) << (32 + i);
+            }
+        }
+
+        const auto traded = last_price != _published[last_price_word];
+        if (dirty == 0 && !traded)
+        {
+            return false;
+        }
+        _published[time_word]       = static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+        _published[last_price_word] = last_price;
+
+        // Odd sequence, then the words, then the next even sequence. The release fence keeps the word stores from
+        // being seen before the odd sequence.
+        const auto sequence = _sequence->load(std::memory_order_relaxed);
+        _sequence->store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        _words[time_word].store(_published[time_word], std::memory_order_relaxed);
+        if (traded)
+        {
+            _words[last_price_word].store(last_price, std::memory_order_relaxed);
+        }
+        while (dirty != 0)
+        {
+            const auto bit  = static_cast<usize>(std::countr_zero(dirty));
+            const auto word = level_word + (bit < 32 ? bit : _depth + bit - 32);
+            _words[word].store(_published[word], std::memory_order_relaxed);
+            dirty &= dirty - 1;
+        }
+
+        _sequence->store(sequence + 2, std::memory_order_release);
+        return true;
+    }
+
+    //==============================================================================================
+    // class : BookReader
+    //==============================================================================================
+
+    BookReader::BookReader(const std::byte* data, usize size, usize depth) noexcept
+        : _data(data)
+        , _size(size)
+        , _depth(depth)
+        , _sequence(reinterpret_cast<const std::atomic<uint64>*>(data + sizeof(SharedBookHeader)))
+        , _words(_sequence + 1)
+    {}
+
+    BookReader::~BookReader() noexcept
+    {
+        release();
+    }
+
+    BookReader::BookReader(BookReader&& other) noexcept
+        : _data(std::exchange(other._data, nullptr))
+        , _size(std::exchange(other._size, 0))
+        , _depth(std::exchange(other._depth, 0))
+        , _sequence(std::exchange(other._sequence, nullptr))
+        , _words(std::exchange(other._words, nullptr))
+    {}
+
+    auto BookReader::operator=(BookReader&& other) noexcept -> BookReader&
+    {
+        if (this != &other)
+        {
+            release();
+            _data     = std::exchange(other._data, nullptr);
+            _size     = std::exchange(other._size, 0);
+            _depth    = std::exchange(other._depth, 0);
+            _sequence = std::exchange(other._sequence, nullptr);
+            _words    = std::exchange(other._words, nullptr);
+        }
+        return *this;
+    }
+
+    auto BookReader::sequence() const noexcept -> uint64
+    {
+        return _sequence->load(std::memory_order_acquire) & ~uint64(1);
+    }
+
+    auto BookReader::read(SharedBookSnapshot& snapshot) const noexcept -> void
+    {
+        // The writer holds the odd sequence for a few stores, retrying right away is cheaper than backing off.
+        while (true)
+        {
+            const auto before = _sequence->load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                continue;
+            }
+
+            const auto time       = _words[time_word].load(std::memory_order_relaxed);
+            const auto last_price = _words[last_price_word].load(std::memory_order_relaxed);
+            for (usize i = 0; i < _depth; ++i)
+            {
+                snapshot.bids[i] = unpack(_words[level_word + i].load(std::memory_order_relaxed));
+                snapshot.asks[i] = unpack(_words[level_word + _depth + i].load(std::memory_order_relaxed));
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence->load(std::memory_order_relaxed) != before)
+            {
+                continue;
+            }
+
+            snapshot.sequence   = before;
+            snapshot.time       = TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::nanoseconds(time)));
+            snapshot.last_price = static_cast<Price>(last_price);
+
+            const auto is_empty = [](const SharedLevel& level) { return level.quantity == 0; };
+            std::fill(snapshot.bids.begin() + static_cast<ssize>(_depth), snapshot.bids.end(), SharedLevel());
+            std::fill(snapshot.asks.begin() + static_cast<ssize>(_depth), snapshot.asks.end(), SharedLevel());
+            snapshot.bid_count = static_cast<usize>(std::find_if(snapshot.bids.begin(), snapshot.bids.end(), is_empty) - snapshot.bids.begin());
+            snapshot.ask_count = static_cast<usize>(std::find_if(snapshot.asks.begin(), snapshot.asks.end(), is_empty) - snapshot.asks.begin());
+            return;
+        }
+    }
+
+    auto BookReader::top() const noexcept -> TopOfBook
+    {
+        while (true)
+        {
+            const auto before = _sequence->load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                continue;
+            }
+
+            const auto bid = unpack(_words[level_word].load(std::memory_order_relaxed));
+            const auto ask = unpack(_words[level_word + _depth].load(std::memory_order_relaxed));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence->load(std::memory_order_relaxed) == before)
+            {
+                return TopOfBook(bid.price, bid.quantity, ask.price, ask.quantity);
+            }
+        }
+    }
+
+#if defined(_WIN32)
+
+    auto BookPublisher::create(std::string_view name, usize) -> BookPublisher
+    {
+        Log::error("Shared memory books are not supported on this platform, {} is not published.", name);
+        return {};
+    }
+
+    auto BookPublisher::release() noexcept -> void {}
+
+    auto BookReader::open(std::string_view name) -> BookReader
+    {
+        Log::error("Shared memory books are not supported on this platform, {} cannot be read.", name);
+        return {};
+    }
+
+    auto BookReader::release() noexcept -> void {}
+
+#else
+
+    auto BookPublisher::create(std::string_view name, usize depth) -> BookPublisher
+    {
+        if (depth == 0 || depth > max_shared_depth)
+        {
+            Log::error("Invalid shared book depth {}, it must be between 1 and {}.", depth, max_shared_depth);
+            return {};
+        }
+
+        const auto path = region_name(name);
+        const auto size = region_size(depth);
+
+        // A region left behind by a crashed writer may have another layout, it is recreated rather than reused.
+        ::shm_unlink(path.c_str());
+        const int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0)
+        {
+            Log::error("Failed to create shared memory {}: {}.", path, std::strerror(errno));
+            return {};
+        }
+
+        void* data = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+        {
+            data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        const auto error = errno;
+        ::close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            Log::error("Failed to map shared memory {}: {}.", path, std::strerror(error));
+            ::shm_unlink(path.c_str());
+            return {};
+        }
+
+        auto* bytes  = static_cast<std::byte*>(data);
+        auto* words = reinterpret_cast<std::atomic<uint64>*>(bytes + sizeof(SharedBookHeader));
+        new (&words[0]) std::atomic<uint64>(0);
+        new (&words[1 + time_word]) std::atomic<uint64>(0);
+        new (&words[1 + last_price_word]) std::atomic<uint64>(invalid_price);
+        for (usize i = level_word; i < word_count(depth); ++i)
+        {
+            new (&words[1 + i]) std::atomic<uint64>(pack(SharedLevel()));
+        }
+
+        // The magic goes last, a reader that opens the region early rejects it instead of reading a partial layout.
+        auto* header    = new (bytes) SharedBookHeader();
+        header->version = version;
+        header->depth   = static_cast<uint32>(depth);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, magic, sizeof(magic));
+        return BookPublisher(path, bytes, size, depth);
+    }
+
+    auto BookPublisher::release() noexcept -> void
+    {
+        if (_data != nullptr)
+        {
+            ::munmap(_data, _size);
+            ::shm_unlink(_name.c_str());
+        }
+        _data     = nullptr;
+        _size     = 0;
+        _sequence = nullptr;
+        _words    = nullptr;
+    }
+
+    auto BookReader::open(std::string_view name) -> BookReader
+    {
+        const auto path = region_name(name);
+        const int  fd   = ::shm_open(path.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+        {
+            Log::error("Failed to open shared memory {}: {}.", path, std::strerror(errno));
+            return {};
+        }
+
+        struct stat status;
+        void*       data = MAP_FAILED;
+        usize       size = 0;
+        if (::fstat(fd, &status) == 0 && static_cast<usize>(status.st_size) >= sizeof(SharedBookHeader))
+        {
+            size = static_cast<usize>(status.st_size);
+            data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            Log::error("Failed to map shared memory {}.", path);
+            return {};
+        }
+
+        const auto* header = static_cast<const SharedBookHeader*>(data);
+        if (std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != BookPublisher::version || header->depth == 0
+            || header->depth > max_shared_depth || region_size(header->depth) > size)
+        {
+            Log::error("Shared memory {} does not hold a version {} book.", path, BookPublisher::version);
+            ::munmap(data, size);
+            return {};
+        }
+        return BookReader(static_cast<const std::byte*>(data), size, header->depth);
+    }
+
+    auto BookReader::release() noexcept -> void
+    {
+        if (_data != nullptr)
+        {
+            ::munmap(const_cast<std::byte*>(_data), _size);
+        }
+        _data     = nullptr;
+        _size     = 0;
+        _sequence = nullptr;
+        _words    = nullptr;
+    }
+
+#endif
+}
@@ -0,0 +1,197 @@
+#include "memory/mapped_file.hpp"
+
+#include "log/log.hpp"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+    #include <cstdlib>
+#else
+    #include <cerrno>
+    #include <cstring>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace flob
+{
+    MappedFile::MappedFile(std::byte* data, usize size, bool is_file) noexcept
+        : _data(data)
+        , _size(size)
+        , _is_file(is_file)
+    {}
+
+    MappedFile::~MappedFile() noexcept
+    {
+        unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : _data(std::exchange(other._data, nullptr))
+        , _size(std::exchange(other._size, 0))
+        , _is_file(std::exchange(other._is_file, false))
+    {}
+
+    auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile&
+    {
+        if (this != &other)
+        {
+            unmap();
+            _data    = std::exchange(other._data, nullptr);
+            _size    = std::exchange(other._size, 0);
+            _is_file = std::exchange(other._is_file, false);
+        }
+        return *this;
+    }
+
+#if defined(_WIN32)
+
+    auto MappedFile::map(std::string_view path, usize size) -> MappedFile
+    {
+        if (!path.empty())
+        {
+            Log::warn("File mappings are not supported on this platform, {} is kept in memory.", path);
+        }
+
+        auto* data = static_cast<std::byte*>(std::calloc(size, 1));
+        if (data == nullptr)
+        {
+            Log::error("Failed to allocate {} bytes.", size);
+            return {};
+        }
+        return MappedFile(data, size, false);
+    }
+
+    auto MappedFile::anonymous(usize size, const PageConfig&) -> MappedFile
+    {
+        return map({}, size);
+    }
+
+    auto MappedFile::sync() noexcept -> void {}
+
+    auto MappedFile::unmap() noexcept -> void
+    {
+        std::free(_data);
+        _data = nullptr;
+        _size = 0;
+    }
+
+#else
+
+    auto MappedFile::map(std::string_view path, usize size) -> MappedFile
+    {
+        if (size == 0)
+        {
+            return {};
+        }
+
+        if (path.empty())
+        {
+            void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data == MAP_FAILED)
+            {
+                Log::error("Failed to map {} bytes: {}.", size, std::strerror(errno));
+                return {};
+            }
+            return MappedFile(static_cast<std::byte*>(data), size, false);
+        }
+
+        const auto name = std::string(path);
+        const int  fd   = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            Log::error("Failed to open {}: {}.", name, std::strerror(errno));
+            return {};
+        }
+
+        // The mapping keeps the file alive, the descriptor is not needed past this point.
+        void* data = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+        {
+            data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        const auto error = errno;
+        ::close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            Log::error("Failed to map {}: {}.", name, std::strerror(error));
+            return {};
+        }
+        return MappedFile(static_cast<std::byte*>(data), size, true);
+    }
+
+    auto MappedFile::anonymous(usize size, const PageConfig& pages) -> MappedFile
+    {
+        if (size == 0)
+        {
+            return {};
+        }
+
+        if (pages.huge_pages == HugePages::Explicit)
+        {
+            const auto rounded  = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+            const auto populate = pages.prefault ? MAP_POPULATE : 0;
+
+            void* data = ::mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+            if (data != MAP_FAILED)
+            {
+                return MappedFile(static_cast<std::byte*>(data), rounded, false);
+            }
+            Log::warn("No huge pages reserved for {} bytes: {}. Using transparent huge pages.", rounded, std::strerror(errno));
+        }
+
+        if (pages.huge_pages == HugePages::Off)
+        {
+            auto file = map({}, size);
+            prepare_pages(file.data(), file.size(), pages);
+            return file;
+        }
+
+        // Over-mapped by a huge page, then trimmed to an aligned range so that every huge page of it can be backed.
+        const auto page   = static_cast<usize>(::sysconf(_SC_PAGESIZE));
+        const auto length = (size + page - 1) / page * page;
+
+        void* data = ::mmap(nullptr, length + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+        {
+            Log::error("Failed to map {} bytes: {}.", size, std::strerror(errno));
+            return {};
+        }
+
+        auto*      base    = static_cast<std::byte*>(data);
+        const auto address = reinterpret_cast<std::uintptr_t>(base);
+        const auto head    = ((address + huge_page_size - 1) & ~(huge_page_size - 1)) - address;
+        if (head > 0)
+        {
+            ::munmap(base, head);
+        }
+        ::munmap(base + head + length, huge_page_size - head);
+
+        prepare_pages(base + head, length, pages);
+        return MappedFile(base + head, length, false);
+    }
+
+    auto MappedFile::sync() noexcept -> void
+    {
+        if (_is_file)
+        {
+            ::msync(_data, _size, MS_ASYNC);
+        }
+    }
+
+    auto MappedFile::unmap() noexcept -> void
+    {
+        if (_data != nullptr)
+        {
+            ::munmap(_data, _size);
+        }
+        _data = nullptr;
+        _size = 0;
+    }
+
+#endif
+}
@@ -0,0 +1,96 @@
+#include "memory/node_pool.hpp"
+
+#include <new>
+#include <utility>
+
+namespace flob
+{
+    NodePool::NodePool(const PageConfig& pages) noexcept
+        : _pages(pages)
+    {}
+
+    NodePool::~NodePool() noexcept
+    {
+        for (auto* chunk : _chunks)
+        {
+            ::operator delete(chunk);
+        }
+    }
+
+    auto NodePool::allocate(usize size) -> void*
+    {
+        if (size > max_block_size)
+        {
+            return ::operator new(size);
+        }
+
+        const auto index = size_class(size);
+        if (auto* block = _free[index])
+        {
+            _free[index] = block->next;
+            return block;
+        }
+        return carve(index);
+    }
+
+    auto NodePool::deallocate(void* block, usize size) noexcept -> void
+    {
+        if (size > max_block_size)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        const auto index = size_class(size);
+        auto*      free  = static_cast<FreeBlock*>(block);
+        free->next       = _free[index];
+        _free[index]     = free;
+    }
+
+    auto NodePool::reserve(usize size, usize count) -> void
+    {
+        if (size > max_block_size)
+        {
+            return;
+        }
+
+        const auto index = size_class(size);
+        for (usize i = 0; i < count; ++i)
+        {
+            deallocate(carve(index), size);
+        }
+    }
+
+    auto NodePool::carve(usize size_class) -> void*
+    {
+        const auto size = (size_class + 1) * granularity;
+        if (static_cast<usize>(_end - _cursor) < size)
+        {
+            // The tail of the previous chunk is too small for this class and is left unused.
+            if (_pages.huge_pages == HugePages::Off)
+            {
+                auto* chunk = static_cast<std::byte*>(::operator new(chunk_size));
+                _chunks.push_back(chunk);
+                prepare_pages(chunk, chunk_size, _pages);
+                _cursor = chunk;
+                _end    = chunk + chunk_size;
+            }
+            else
+            {
+                auto chunk = MappedFile::anonymous(huge_page_size, _pages);
+                if (chunk.empty())
+                {
+                    throw std::bad_alloc();
+                }
+                _cursor = chunk.data();
+                _end    = chunk.data() + chunk.size();
+                _mapped_chunks.push_back(std::move(chunk));
+            }
+            _memory_usage += static_cast<usize>(_end - _cursor);
+        }
+
+        auto* block = _cursor;
+        _cursor += size;
+        return block;
+    }
+}
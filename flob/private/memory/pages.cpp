@@ -0,0 +1,58 @@
+#include "memory/pages.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace flob
+{
+#if defined(__linux__)
+
+    auto prepare_pages(void* data, usize size, const PageConfig& pages) noexcept -> void
+    {
+        if (data == nullptr || size == 0)
+        {
+            return;
+        }
+
+        const auto begin = reinterpret_cast<std::uintptr_t>(data);
+        const auto end   = begin + size;
+
+        // Only the huge pages that fit entirely in the range can be backed by one. The advice comes first so that the
+        // faults below already allocate huge pages.
+        if (pages.huge_pages != HugePages::Off)
+        {
+            const auto first = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+            const auto last  = end & ~(huge_page_size - 1);
+            if (first < last)
+            {
+                ::madvise(reinterpret_cast<void*>(first), last - first, MADV_HUGEPAGE);
+            }
+        }
+
+        if (pages.prefault)
+        {
+            // A write per page, of what it already holds, so that it is mapped and private before the hot path runs.
+            const auto page  = static_cast<usize>(::sysconf(_SC_PAGESIZE));
+            const auto touch = [](std::uintptr_t address) {
+                auto* byte = reinterpret_cast<volatile std::byte*>(address);
+                *byte      = *byte;
+            };
+            touch(begin);
+            for (auto address = (begin & ~(page - 1)) + page; address < end; address += page)
+            {
+                touch(address);
+            }
+        }
+    }
+
+#else
+
+    auto prepare_pages(void*, usize, const PageConfig&) noexcept -> void {}
+
+#endif
+}
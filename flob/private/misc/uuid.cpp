@@ -4,9 +4,10 @@
 
 namespace flob
 {
-    static auto random_device        = std::random_device();
-    static auto random_engine        = std::mt19937_64(random_device());
-    static auto uniform_distribution = std::uniform_int_distribution<uint64>();
+    // Per thread, so that books running on different threads never share state.
+    static thread_local auto random_device        = std::random_device();
+    static thread_local auto random_engine        = std::mt19937_64(random_device());
+    static thread_local auto uniform_distribution = std::uniform_int_distribution<uint64>();
 
     UUID::UUID()
         : _uuid(uniform_distribution(random_engine))
@@ -0,0 +1,538 @@
+#include "net/order_server.hpp"
+
+#include "log/log.hpp"
+#include "protocol/order_entry.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+#if defined(__linux__)
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace flob
+{
+    OrderServer::OrderServer(OrderBook& book, const OrderServerConfig& config)
+        : _book(book)
+        , _config(config)
+        , _running(false)
+    {}
+
+#if defined(__linux__)
+
+    namespace
+    {
+        // Tags of the epoll events that are not a connection slot.
+        constexpr uint64 listen_tag = std::numeric_limits<uint64>::max();
+        constexpr uint64 wakeup_tag = listen_tag - 1;
+
+        constexpr int32 max_events = 64;
+
+        // Book ids are the session of the owner above the id of the client.
+        constexpr uint32 client_id_bits = 40;
+        constexpr uint64 client_id_mask = (uint64(1) << client_id_bits) - 1;
+        constexpr uint64 session_mask   = (uint64(1) << (64 - client_id_bits)) - 1;
+
+        constexpr auto client_id(OrderId order_id) noexcept -> OrderId
+        {
+            return OrderId(static_cast<uint64>(order_id) & client_id_mask);
+        }
+    }
+
+    OrderServer::~OrderServer() noexcept
+    {
+        for (usize slot = 0; slot < _connections.size(); ++slot)
+        {
+            if (_connections[slot].fd >= 0)
+            {
+                ::close(_connections[slot].fd);
+            }
+        }
+        for (const auto fd : {_listen, _wakeup, _epoll})
+        {
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+        }
+        if (_listen >= 0 && _config.port == 0)
+        {
+            ::unlink(_config.path.c_str());
+        }
+    }
+
+    auto OrderServer::start() -> bool
+    {
+        if (_config.port == 0)
+        {
+            sockaddr_un address{};
+            if (_config.path.empty() || _config.path.size() >= sizeof(address.sun_path))
+            {
+                Log::error("Invalid socket path {}.", _config.path);
+                return false;
+            }
+
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, _config.path.c_str(), _config.path.size() + 1);
+            ::unlink(_config.path.c_str());
+
+            _listen = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (_listen < 0 || ::bind(_listen, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                Log::error("Failed to bind {}: {}.", _config.path, std::strerror(errno));
+                return false;
+            }
+        }
+        else
+        {
+            sockaddr_in address{};
+            address.sin_family      = AF_INET;
+            address.sin_port        = htons(_config.port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            const int32 reuse = 1;
+            _listen           = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (_listen < 0 || ::setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0
+                || ::bind(_listen, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                Log::error("Failed to bind port {}: {}.", _config.port, std::strerror(errno));
+                return false;
+            }
+        }
+
+        if (::listen(_listen, static_cast<int32>(_config.max_connections)) != 0)
+        {
+            Log::error("Failed to listen: {}.", std::strerror(errno));
+            return false;
+        }
+
+        _epoll  = ::epoll_create1(0);
+        _wakeup = ::eventfd(0, EFD_NONBLOCK);
+        if (_epoll < 0 || _wakeup < 0)
+        {
+            Log::error("Failed to create the event loop: {}.", std::strerror(errno));
+            return false;
+        }
+
+        epoll_event event{};
+        event.events   = EPOLLIN;
+        event.data.u64 = listen_tag;
+        ::epoll_ctl(_epoll, EPOLL_CTL_ADD, _listen, &event);
+        event.data.u64 = wakeup_tag;
+        ::epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event);
+
+        _connections.resize(_config.max_connections);
+        _notified.reserve(_config.max_connections);
+        _slot_bits = static_cast<uint32>(std::bit_width(_config.max_connections - 1));
+        _running.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    auto OrderServer::run() -> void
+    {
+        // A zero timeout never parks the thread, the wakeup then costs a poll instead of a scheduler round trip.
+        const auto timeout = _config.busy_poll ? std::chrono::milliseconds(0) : std::chrono::milliseconds(-1);
+        while (_running.load(std::memory_order_relaxed))
+        {
+            poll(timeout);
+        }
+    }
+
+    auto OrderServer::poll(std::chrono::milliseconds timeout) -> usize
+    {
+        epoll_event events[max_events];
+
+        const auto count = ::epoll_wait(_epoll, events, max_events, static_cast<int32>(timeout.count()));
+        if (count <= 0)
+        {
+            if (count < 0 && errno != EINTR)
+            {
+                Log::error("Failed to wait for events: {}.", std::strerror(errno));
+                _running.store(false, std::memory_order_relaxed);
+            }
+            return 0;
+        }
+
+        ++_stats.wakeups;
+        for (int32 i = 0; i < count; ++i)
+        {
+            const auto tag = events[i].data.u64;
+            if (tag == listen_tag)
+            {
+                accept_connections();
+                continue;
+            }
+            if (tag == wakeup_tag)
+            {
+                uint64 value;
+                [[maybe_unused]] const auto _ = ::read(_wakeup, &value, sizeof(value));
+                continue;
+            }
+
+            // An earlier event of the batch may have closed the slot.
+            const auto slot = static_cast<usize>(tag);
+            if (_connections[slot].fd < 0)
+            {
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                close_connection(slot);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT)
+            {
+                flush(slot);
+            }
+            if ((events[i].events & EPOLLIN) && _connections[slot].fd >= 0)
+            {
+                on_readable(slot);
+            }
+        }
+        return static_cast<usize>(count);
+    }
+
+    auto OrderServer::stop() noexcept -> void
+    {
+        _running.store(false, std::memory_order_relaxed);
+        if (_wakeup >= 0)
+        {
+            const uint64                value = 1;
+            [[maybe_unused]] const auto _     = ::write(_wakeup, &value, sizeof(value));
+        }
+    }
+
+    auto OrderServer::accept_connections() -> void
+    {
+        while (true)
+        {
+            const auto fd = ::accept4(_listen, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    Log::warn("Failed to accept a connection: {}.", std::strerror(errno));
+                }
+                return;
+            }
+
+            // A slot whose generations are used up is retired, a further session would reuse the namespace of an
+            // earlier one and reach its resting orders.
+            const auto last_generation = static_cast<uint32>(session_mask >> _slot_bits);
+
+            usize slot = 0;
+            while (slot < _connections.size() && (_connections[slot].fd >= 0 || _connections[slot].generation == last_generation))
+            {
+                ++slot;
+            }
+            if (slot == _connections.size())
+            {
+                Log::warn("Connection refused, the limit of {} is reached or the free slots are retired.", _config.max_connections);
+                ::close(fd);
+                continue;
+            }
+
+            if (_config.port != 0)
+            {
+                // Responses are latency sensitive and already batched, Nagle would only delay them. Busy polling the
+                // socket needs privileges above the system default, it is a hint that may be refused.
+                const int32 enable = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                if (_config.busy_poll)
+                {
+                    const int32 busy_poll_us = 50;
+                    ::setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us));
+                }
+            }
+
+            auto& connection = _connections[slot];
+            connection.fd    = fd;
+            connection.rx.resize(_config.buffer_size);
+            connection.rx_size = 0;
+            connection.tx.clear();
+            connection.tx_sent = 0;
+            connection.events  = EPOLLIN;
+            connection.account.reset();
+
+            // Orders of the previous sessions of the slot stay out of reach of the new one. Generations start at 1 so
+            // that no session owns the ids of orders entered into the book directly.
+            connection.session = (static_cast<uint64>(++connection.generation) << _slot_bits) | slot;
+            if (connection.generation == last_generation)
+            {
+                Log::warn("Connection {} is the last session of its slot.", slot);
+            }
+
+            epoll_event event{};
+            event.events   = connection.events;
+            event.data.u64 = slot;
+            ::epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event);
+
+            ++_stats.connections;
+            Log::info("Connection {} accepted.", slot);
+        }
+    }
+
+    auto OrderServer::close_connection(usize slot) -> void
+    {
+        auto& connection = _connections[slot];
+        ::epoll_ctl(_epoll, EPOLL_CTL_DEL, connection.fd, nullptr);
+        ::close(connection.fd);
+        connection.fd = -1;
+        Log::info("Connection {} closed.", slot);
+    }
+
+    auto OrderServer::on_readable(usize slot) -> void
+    {
+        auto& connection = _connections[slot];
+
+        const auto received = ::recv(connection.fd, connection.rx.data() + connection.rx_size, connection.rx.size() - connection.rx_size, 0);
+        if (received <= 0)
+        {
+            if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            {
+                close_connection(slot);
+            }
+            return;
+        }
+        connection.rx_size += static_cast<usize>(received);
+        _stats.bytes_received += static_cast<uint64>(received);
+
+        // The responses of the whole batch accumulate before a single send.
+        struct Session
+        {
+            OrderServer& server;
+            usize        slot;
+
+            auto book_id(OrderId order_id) const noexcept -> std::optional<OrderId>
+            {
+                // The rest of the batch of a connection dropped on the way is not applied.
+                if (static_cast<uint64>(order_id) > client_id_mask || server._connections[slot].fd < 0)
+                {
+                    return std::nullopt;
+                }
+                return OrderId((server._connections[slot].session << client_id_bits) | static_cast<uint64>(order_id));
+            }
+
+            auto account(AccountId account) noexcept -> std::optional<AccountId>
+            {
+                if (!server.claim_account(slot, account))
+                {
+                    return std::nullopt;
+                }
+                return account;
+            }
+
+            auto reply(std::span<const std::byte> message) -> void
+            {
+                server.send(slot, message);
+            }
+
+            auto execution(const Trade& trade) -> void
+            {
+                server.report_execution(trade);
+            }
+        };
+
+        Session    session(*this, slot);
+        const auto result = apply_messages(_book, std::span<const std::byte>(connection.rx.data(), connection.rx_size), session);
+        _stats.messages += result.messages;
+        _stats.trades += result.trades;
+
+        // Executions of the batch may have reached the orders of other sessions.
+        for (const auto other : _notified)
+        {
+            _connections[other].notified = false;
+            if (other != slot && _connections[other].fd >= 0)
+            {
+                flush(other);
+            }
+        }
+        _notified.clear();
+
+        if (connection.fd < 0)
+        {
+            return;
+        }
+
+        if (result.malformed)
+        {
+            Log::warn("Connection {} sent a malformed stream.", slot);
+            close_connection(slot);
+            return;
+        }
+
+        // A partial message stays at the front for the next receive.
+        connection.rx_size -= result.consumed;
+        if (connection.rx_size > 0 && result.consumed > 0)
+        {
+            std::memmove(connection.rx.data(), connection.rx.data() + result.consumed, connection.rx_size);
+        }
+
+        flush(slot);
+    }
+
+    auto OrderServer::send(usize slot, std::span<const std::byte> message) -> void
+    {
+        auto& connection = _connections[slot];
+        if (connection.fd < 0)
+        {
+            return;
+        }
+        if (connection.tx.size() - connection.tx_sent + message.size() > _config.max_backlog)
+        {
+            Log::warn("Connection {} dropped, its send backlog exceeds {} bytes.", slot, _config.max_backlog);
+            close_connection(slot);
+            return;
+        }
+
+        const auto offset = connection.tx.size();
+        connection.tx.resize(offset + message.size());
+        std::memcpy(connection.tx.data() + offset, message.data(), message.size());
+
+        if (!connection.notified)
+        {
+            connection.notified = true;
+            _notified.push_back(slot);
+        }
+    }
+
+    auto OrderServer::report_execution(const Trade& trade) -> void
+    {
+        std::array<std::byte, wire::executed_size> buffer;
+
+        const auto buyer  = owner(trade.bid_id);
+        const auto seller = owner(trade.ask_id);
+        const auto notify = [&](usize slot) {
+            if (slot == _connections.size())
+            {
+                return;
+            }
+
+            auto report   = trade;
+            report.bid_id = slot == buyer ? client_id(trade.bid_id) : OrderId(0);
+            report.ask_id = slot == seller ? client_id(trade.ask_id) : OrderId(0);
+            send(slot, std::span<const std::byte>(buffer.data(), encode_execution(buffer, report)));
+        };
+
+        notify(buyer);
+        if (seller != buyer)
+        {
+            notify(seller);
+        }
+    }
+
+    auto OrderServer::owner(OrderId order_id) const noexcept -> usize
+    {
+        // Sessions that have closed since own nothing, their orders stay in the book unreported.
+        const auto session = static_cast<uint64>(order_id) >> client_id_bits;
+        const auto slot    = static_cast<usize>(session & ((uint64(1) << _slot_bits) - 1));
+        if (slot >= _connections.size() || _connections[slot].fd < 0 || _connections[slot].session != session)
+        {
+            return _connections.size();
+        }
+        return slot;
+    }
+
+    auto OrderServer::claim_account(usize slot, AccountId account) noexcept -> bool
+    {
+        auto& connection = _connections[slot];
+        if (connection.account)
+        {
+            return *connection.account == account;
+        }
+
+        if (account != invalid_account)
+        {
+            for (const auto& other : _connections)
+            {
+                if (other.fd >= 0 && other.account == account)
+                {
+                    return false;
+                }
+            }
+        }
+        connection.account = account;
+        return true;
+    }
+
+    auto OrderServer::flush(usize slot) -> void
+    {
+        auto& connection = _connections[slot];
+        while (connection.tx_sent < connection.tx.size())
+        {
+            const auto sent = ::send(connection.fd, connection.tx.data() + connection.tx_sent, connection.tx.size() - connection.tx_sent, MSG_NOSIGNAL);
+            if (sent < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    break;
+                }
+                close_connection(slot);
+                return;
+            }
+            connection.tx_sent += static_cast<usize>(sent);
+            _stats.bytes_sent += static_cast<uint64>(sent);
+        }
+
+        if (connection.tx_sent == connection.tx.size())
+        {
+            connection.tx.clear();
+            connection.tx_sent = 0;
+        }
+        update_interest(slot);
+    }
+
+    auto OrderServer::update_interest(usize slot) -> void
+    {
+        auto& connection = _connections[slot];
+
+        // Reading stops while the backlog is over the limit, the client has to drain its responses first.
+        const auto pending = connection.tx.size() - connection.tx_sent;
+        const auto events  = (pending > _config.buffer_size ? 0u : static_cast<uint32>(EPOLLIN)) | (pending > 0 ? static_cast<uint32>(EPOLLOUT) : 0u);
+        if (events == connection.events)
+        {
+            return;
+        }
+
+        epoll_event event{};
+        event.events   = events;
+        event.data.u64 = slot;
+        ::epoll_ctl(_epoll, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = events;
+    }
+
+#else
+
+    OrderServer::~OrderServer() noexcept = default;
+
+    auto OrderServer::start() -> bool
+    {
+        Log::error("The order server is not supported on this platform.");
+        return false;
+    }
+
+    auto OrderServer::run() -> void {}
+
+    auto OrderServer::poll(std::chrono::milliseconds) -> usize
+    {
+        return 0;
+    }
+
+    auto OrderServer::stop() noexcept -> void
+    {
+        _running.store(false, std::memory_order_relaxed);
+    }
+
+#endif
+}
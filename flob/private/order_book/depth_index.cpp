@@ -0,0 +1,78 @@
+#include "order_book/depth_index.hpp"
+
+#include <algorithm>
+
+namespace flob
+{
+    DepthIndex::DepthIndex(Price min_price, Price max_price) noexcept
+        : _min_price(min_price)
+        , _max_price(max_price)
+    {
+        if (max_price <= min_price)
+        {
+            return;
+        }
+
+        const auto size = static_cast<usize>(max_price - min_price) + 1;
+        _bids           = Ladder(FenwickTree<int64>(size), FenwickTree<int64>(size));
+        _asks           = Ladder(FenwickTree<int64>(size), FenwickTree<int64>(size));
+    }
+
+    auto DepthIndex::cost(Side side, Quantity quantity) const noexcept -> ExecutionCost
+    {
+        ExecutionCost result(0, 0, invalid_price);
+        if (!enabled() || quantity == 0)
+        {
+            return result;
+        }
+
+        const auto& ladder = side == Side::Buy ? _bids : _asks;
+        const auto  size   = ladder.quantities.size();
+        const auto  total  = ladder.quantities.prefix(size);
+        if (total == 0)
+        {
+            return result;
+        }
+
+        // The level where the cumulative quantity reaches the target is only partly taken.
+        const auto target = std::min<int64>(quantity, total);
+        const auto last   = ladder.quantities.lower_bound(target);
+        const auto before = ladder.quantities.prefix(last);
+
+        result.quantity    = static_cast<Quantity>(target);
+        result.worst_price = price(side, last);
+        result.notional    = static_cast<uint64>(ladder.notionals.prefix(last) + (target - before) * result.worst_price);
+        return result;
+    }
+
+    auto DepthIndex::price_for(Side side, Quantity quantity) const noexcept -> Price
+    {
+        if (!enabled() || quantity == 0)
+        {
+            return invalid_price;
+        }
+
+        const auto& ladder = side == Side::Buy ? _bids : _asks;
+        const auto  last   = ladder.quantities.lower_bound(quantity);
+        return last < ladder.quantities.size() ? price(side, last) : invalid_price;
+    }
+
+    auto DepthIndex::depth(Side side, Price ticks) const noexcept -> Quantity
+    {
+        if (!enabled())
+        {
+            return 0;
+        }
+
+        const auto& ladder = side == Side::Buy ? _bids : _asks;
+        const auto  size   = ladder.quantities.size();
+        const auto  best   = ladder.quantities.lower_bound(1);
+        if (best == size)
+        {
+            return 0;
+        }
+
+        const auto end = std::min<usize>(size, best + static_cast<usize>(ticks) + 1);
+        return static_cast<Quantity>(ladder.quantities.prefix(end));
+    }
+}
@@ -0,0 +1,73 @@
+#include "order_book/depth_levels.hpp"
+
+#include "simd/depth_kernels.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace flob
+{
+    auto DepthLevels::quantity(usize levels) const noexcept -> uint64
+    {
+        return depth_kernels().sum(_quantities.data(), std::min(levels, size()));
+    }
+
+    auto DepthLevels::cumulative(Vector<uint64>& cumulative) const noexcept -> void
+    {
+        cumulative.resize(size());
+        depth_kernels().prefix_sum(_quantities.data(), cumulative.data(), size());
+    }
+
+    auto DepthLevels::vwap(usize levels) const noexcept -> float64
+    {
+        const auto& kernels  = depth_kernels();
+        const auto  count    = std::min(levels, size());
+        const auto  quantity = kernels.sum(_quantities.data(), count);
+        if (quantity == 0)
+        {
+            return std::numeric_limits<float64>::quiet_NaN();
+        }
+        return static_cast<float64>(kernels.dot(_prices.data(), _quantities.data(), count)) / static_cast<float64>(quantity);
+    }
+
+    auto DepthLevels::cost(Quantity quantity) const noexcept -> ExecutionCost
+    {
+        ExecutionCost result(0, 0, invalid_price);
+        if (quantity == 0)
+        {
+            return result;
+        }
+
+        const auto& kernels = depth_kernels();
+        const auto  last    = kernels.find_cumulative(_quantities.data(), size(), quantity);
+        if (last == size())
+        {
+            // The side holds less than asked, all of it is taken.
+            result.quantity = static_cast<Quantity>(kernels.sum(_quantities.data(), size()));
+            if (result.quantity > 0)
+            {
+                result.notional    = kernels.dot(_prices.data(), _quantities.data(), size());
+                result.worst_price = _prices.back();
+            }
+            return result;
+        }
+
+        // The level where the cumulative quantity reaches the target is only partly taken.
+        const auto before  = kernels.sum(_quantities.data(), last);
+        result.quantity    = quantity;
+        result.worst_price = _prices[last];
+        result.notional    = kernels.dot(_prices.data(), _quantities.data(), last) + (quantity - before) * result.worst_price;
+        return result;
+    }
+
+    auto DepthLevels::price_for(Quantity quantity) const noexcept -> Price
+    {
+        if (quantity == 0)
+        {
+            return invalid_price;
+        }
+
+        const auto last = depth_kernels().find_cumulative(_quantities.data(), size(), quantity);
+        return last < size() ? _prices[last] : invalid_price;
+    }
+}
@@ -2,232 +2,1083 @@
 
 #include "log/log.hpp"
 
-#include <numeric>
+#include <algorithm>
+#include <limits>
 
 namespace flob
 {
-    OrderBook::OrderBook(const OrderBookConfig& config)
-        : _session(config.session)
-        , _gfd_expired_today(false)
-    {}
+    namespace
+    {
+        // Level helpers keep the level totals in step with the orders, and return the change of displayed quantity
+        // at the price of the order for the book to report.
+
+        template <typename Levels>
+        auto insert_order(Levels& levels, OrderPool& orders, OrderHandle handle) -> int64
+        {
+            const auto& order = orders[handle];
+
+            auto& level = levels[order.price];
+            level.visible_quantity += order.visible_quantity();
+            level.hidden_quantity += order.remaining_quantity - order.visible_quantity();
+            level.reserve_quantity += order.reserve_quantity;
+            orders.push_back(level.orders, handle);
+            return order.visible_quantity();
+        }
+
+        template <typename Levels>
+        auto erase_order(Levels& levels, OrderPool& orders, OrderHandle handle) -> int64
+        {
+            const auto& order = orders[handle];
+            const auto  it    = levels.find(order.price);
+
+            auto& level = it->second;
+            level.visible_quantity -= order.visible_quantity();
+            level.hidden_quantity -= order.remaining_quantity - order.visible_quantity();
+            level.reserve_quantity -= order.reserve_quantity;
+            orders.unlink(level.orders, handle);
+            if (level.orders.empty())
+            {
+                levels.erase(it);
+            }
+            return -static_cast<int64>(order.visible_quantity());
+        }
+
+        template <typename Level>
+        auto fill_order(Level& level, RestingOrder& order, Quantity quantity) -> int64
+        {
+            order.fill(quantity);
+            if (order.is_hidden())
+            {
+                level.hidden_quantity -= quantity;
+                return 0;
+            }
+
+            level.visible_quantity -= quantity;
+            return -static_cast<int64>(quantity);
+        }
+
+        template <typename Stops>
+        auto erase_stop_order(Stops& stops, OrderPool& orders, OrderHandle handle) -> void
+        {
+            const auto it = stops.find(orders.details(handle).stop_price);
+            orders.unlink(it->second, handle);
+            if (it->second.empty())
+            {
+                stops.erase(it);
+            }
+        }
+
+        template <typename Level>
+        auto level_quantity(const Level& level) -> uint64
+        {
+            return static_cast<uint64>(level.visible_quantity) + level.hidden_quantity + level.reserve_quantity;
+        }
 
-    auto OrderBook::infos() const -> OrderBookInfos
+        // Notional of taking `quantity` from the levels best price first, hidden and reserve quantity included like
+        // a market order would, unknown_notional when there are none.
+        template <typename Levels>
+        auto sweep_notional(const Levels& levels, uint64 quantity) -> uint64
+        {
+            if (levels.empty())
+            {
+                return unknown_notional;
+            }
+
+            uint64 notional = 0;
+            for (auto it = levels.begin(); it != levels.end() && quantity > 0; ++it)
+            {
+                const auto taken = std::min(quantity, level_quantity(it->second));
+                notional += taken * it->first;
+                quantity -= taken;
+            }
+            return notional;
+        }
+
+        // Moves an exhausted iceberg to the tail of its level with a fresh slice. Only the queue links change, the
+        // order keeps its handle.
+        template <typename Level>
+        auto replenish_order(Level& level, OrderPool& orders, OrderHandle handle) -> int64
+        {
+            auto&      order = orders[handle];
+            const auto slice = order.replenish(orders.details(handle).peak_quantity);
+            level.visible_quantity += slice;
+            level.reserve_quantity -= slice;
+            orders.unlink(level.orders, handle);
+            orders.push_back(level.orders, handle);
+            return slice;
+        }
+
+        // The node type of a map cannot be named, so its nodes are reserved by growing a scratch map on the same pool
+        // and dropping it, which leaves them on the free list.
+        template <typename Levels>
+        auto reserve_nodes(const Levels& levels, usize count) -> void
+        {
+            Levels scratch(levels.get_allocator());
+            for (usize i = 0; i < count; ++i)
+            {
+                scratch.try_emplace(scratch.end(), static_cast<Price>(i));
+            }
+        }
+    }
+
+    template <typename MatchingPolicy>
+    BasicOrderBook<MatchingPolicy>::BasicOrderBook(const OrderBookConfig& config)
+        : _nodes(std::make_unique<NodePool>(config.pages))
+        , _bids(_nodes.get())
+        , _asks(_nodes.get())
+        , _buy_stops(_nodes.get())
+        , _sell_stops(_nodes.get())
+        , _last_price(invalid_price)
+        , _now(config.start_time)
+        , _timer_tick(config.timer_tick)
+        , _manual_clock(config.manual_clock)
+        , _timers(to_tick(config.start_time))
+        , _phase(config.batch_interval > std::chrono::nanoseconds::zero() ? TradingPhase::Auction : config.initial_phase)
+        , _batch_interval(std::chrono::duration_cast<TimePoint::duration>(config.batch_interval))
+        , _next_batch(config.start_time + _batch_interval)
+        , _session(config.session)
+        , _post_only_policy(config.post_only_policy)
+        , _matching(config.matching)
+        , _risk(config.risk)
+        , _pnl(config.pnl)
+        , _features(config.features)
+        , _tape(config.tape)
+        , _publisher(config.publisher)
+        , _view(config.view)
+        , _depth(config.depth_min_price, config.depth_max_price)
+        , _touched_bid(invalid_price)
+        , _touched_ask(invalid_price)
+        , _consolidated(config.consolidated)
+        , _venue(config.venue)
+    {
+        if (_consolidated && _venue >= _consolidated->venues())
+        {
+            Log::error("Venue {} out of the {} venues of the consolidated book, the book does not feed it.", _venue, _consolidated->venues());
+            _consolidated = nullptr;
+        }
+        _orders.reserve(config.order_capacity, config.pages);
+        _timers.reserve(config.order_capacity, config.pages);
+
+        // Both sides share their node size.
+        reserve_nodes(_bids, config.level_capacity * 2);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::best_bid() const noexcept -> Price
+    {
+        return _bids.empty() ? invalid_price : _bids.begin()->first;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::best_ask() const noexcept -> Price
+    {
+        return _asks.empty() ? invalid_price : _asks.begin()->first;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::mid_price() const noexcept -> float64
+    {
+        if (_bids.empty() || _asks.empty())
+        {
+            return std::numeric_limits<float64>::quiet_NaN();
+        }
+        return (static_cast<float64>(_bids.begin()->first) + _asks.begin()->first) / 2.0;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::micro_price() const noexcept -> float64
+    {
+        if (_bids.empty() || _asks.empty())
+        {
+            return std::numeric_limits<float64>::quiet_NaN();
+        }
+
+        const auto& [bid_price, bid_level] = *_bids.begin();
+        const auto& [ask_price, ask_level] = *_asks.begin();
+
+        const auto depth = static_cast<float64>(bid_level.visible_quantity) + ask_level.visible_quantity;
+        if (depth == 0.0)
+        {
+            return mid_price();
+        }
+        return (static_cast<float64>(bid_price) * ask_level.visible_quantity + static_cast<float64>(ask_price) * bid_level.visible_quantity) / depth;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::top() const noexcept -> TopOfBook
+    {
+        TopOfBook top;
+        if (!_bids.empty())
+        {
+            top.bid_price    = _bids.begin()->first;
+            top.bid_quantity = _bids.begin()->second.visible_quantity;
+        }
+        if (!_asks.empty())
+        {
+            top.ask_price    = _asks.begin()->first;
+            top.ask_quantity = _asks.begin()->second.visible_quantity;
+        }
+        return top;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::infos() const -> OrderBookInfos
     {
         OrderBookInfos infos;
+        this->infos(infos);
+        return infos;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::infos(OrderBookInfos& infos) const -> void
+    {
+        infos.bids.clear();
+        infos.asks.clear();
         infos.bids.reserve(_bids.size());
         infos.asks.reserve(_asks.size());
 
-        auto create_level_infos = [](auto price, const auto& orders) {
-            auto quantity = std::accumulate(orders.begin(), orders.end(), static_cast<Quantity>(0), [](auto s, const auto& o) {
-                return s + o->remaining_quantity();
-            });
-            return OrderBookLevelInfos(price, quantity);
+        for (const auto& [price, level] : _bids)
+        {
+            if (level.visible_quantity > 0)
+            {
+                infos.bids.push_back(OrderBookLevelInfos(price, level.visible_quantity));
+            }
+        }
+        for (const auto& [price, level] : _asks)
+        {
+            if (level.visible_quantity > 0)
+            {
+                infos.asks.push_back(OrderBookLevelInfos(price, level.visible_quantity));
+            }
+        }
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::depth_levels(Side side, DepthLevels& levels, usize count) const -> void
+    {
+        const auto fill = [&](const auto& side_levels) {
+            const auto limit  = count == 0 ? static_cast<usize>(side_levels.size()) : std::min<usize>(count, side_levels.size());
+            usize      filled = 0;
+            levels.resize(limit);
+            for (auto it = side_levels.begin(); it != side_levels.end() && filled < limit; ++it)
+            {
+                if (it->second.visible_quantity > 0)
+                {
+                    levels.set(filled++, it->first, it->second.visible_quantity);
+                }
+            }
+            levels.resize(filled);
         };
 
-        for (const auto& [price, orders] : _bids)
+        if (side == Side::Buy)
         {
-            infos.bids.push_back(create_level_infos(price, orders));
+            fill(_bids);
         }
-        for (const auto& [price, orders] : _asks)
+        else
         {
-            infos.asks.push_back(create_level_infos(price, orders));
+            fill(_asks);
         }
+    }
 
-        return infos;
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::add_order(const OrderRef& order) -> Trades
+    {
+        Trades trades;
+        add_order(*order, trades);
+        return trades;
     }
 
-    auto OrderBook::add_order(const OrderRef& order) -> Vector<Trade>
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::add_order(const Order& order, Trades& trades) -> OrderStatus
     {
-        cancel_gfd_if_needed();
+        const auto status = submit_order(order, trades);
+        publish_features();
+        return status;
+    }
 
-        if (_orders.contains(order->id()))
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::submit_order(const Order& order, Trades& trades) -> OrderStatus
+    {
+        // A batch auction may come due before the order arrives.
+        if (!_manual_clock)
         {
-            Log::warn("Order with ID {} already exists in order book.", static_cast<uint64>(order->id()));
-            return {};
+            advance_clock(Clock::now(), trades);
         }
 
-        // TODO: Handle market order first
+        if (_orders.find(order.id()) != invalid_handle)
+        {
+            Log::warn("Order with ID {} already exists in order book.", static_cast<uint64>(order.id()));
+            return OrderStatus::DuplicateId;
+        }
 
-        OrderRefs::iterator location;
-        switch (order->side())
+        if (order.type() == OrderType::GTT && order.expiry() <= _now)
         {
-            case Side::Sell:
-            {
-                auto& orders = _asks[order->price()];
-                orders.push_back(order);
-                location = std::prev(orders.end());
-                break;
-            }
-            case Side::Buy:
+            // Already expired, it would be cancelled on the next tick anyway.
+            return OrderStatus::Expired;
+        }
+
+        if (_risk)
+        {
+            if (const auto check = _risk->check(order, notional(order)); check != RiskCheck::Accepted)
             {
-                auto& orders = _bids[order->price()];
-                orders.push_back(order);
-                location = std::prev(orders.end());
-                break;
+                Log::trace("Order with ID {} rejected by risk check {}.", static_cast<uint64>(order.id()), static_cast<uint8>(check));
+                return OrderStatus::RiskLimit;
             }
-            default: Log::error("Unknown order side."); return {};
         }
 
-        _orders.emplace(order->id(), OrderEntry(order, location));
-        return match_orders();
+        auto       status = OrderStatus::Accepted;
+        const auto handle = _orders.insert(order);
+        if (order.is_stop())
+        {
+            park_stop_order(handle);
+        }
+        else
+        {
+            status = place_order(handle, trades);
+        }
+
+        // Stops only trigger on trades, or on arrival when they are already through the last price.
+        trigger_stop_orders(trades);
+        return status;
     }
 
-    auto OrderBook::cancel_order(OrderId order_id) -> void
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::notional(const Order& order) const -> uint64
     {
-        if (!_orders.contains(order_id))
+        if (!order.is_market_order())
         {
-            Log::warn("Order with ID {} does not exist in order book.", static_cast<uint64>(order_id));
-            return;
+            return static_cast<uint64>(order.price()) * order.total_quantity();
+        }
+
+        // A stop market order sweeps the book of when it triggers, which is unknown yet: its stop price is the only
+        // reference it has.
+        if (order.is_stop())
+        {
+            return static_cast<uint64>(order.stop_price()) * order.total_quantity();
+        }
+        return order.side() == Side::Buy ? sweep_notional(_asks, order.total_quantity()) : sweep_notional(_bids, order.total_quantity());
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::place_order(OrderHandle handle, Trades& trades) -> OrderStatus
+    {
+        auto&      order = _orders[handle];
+        const auto id    = _orders.details(handle).id;
+
+        // Market orders take whatever liquidity is on the other side and never rest, like an IOC at the worst price.
+        const auto is_immediate = _orders.details(handle).type == OrderType::IOC || order.is_market_order();
+        if (_phase == TradingPhase::Auction && is_immediate)
+        {
+            reject_order(handle);
+            return OrderStatus::Auction;
         }
 
-        const auto& [order, location] = _orders.at(order_id);
-        const auto price              = order->price();
-        switch (order->side())
+        if (order.is_market_order())
         {
-            case Side::Sell:
+            if (order.side == Side::Buy ? _asks.empty() : _bids.empty())
             {
-                auto& orders = _asks.at(price);
-                orders.erase(location);
-                if (orders.empty())
-                {
-                    _asks.erase(price);
-                }
-                break;
+                reject_order(handle);
+                return OrderStatus::NoLiquidity;
             }
-            case Side::Buy:
+            order.price = order.side == Side::Buy ? _asks.rbegin()->first : _bids.rbegin()->first;
+        }
+
+        if (order.is_post_only() && !accept_post_only(order))
+        {
+            reject_order(handle);
+            return OrderStatus::WouldCross;
+        }
+
+        switch (order.side)
+        {
+            case Side::Sell: display(Side::Sell, order.price, insert_order(_asks, _orders, handle)); break;
+            case Side::Buy:  display(Side::Buy, order.price, insert_order(_bids, _orders, handle)); break;
+            default:         Log::error("Unknown order side."); reject_order(handle); return OrderStatus::Invalid;
+        }
+
+        _orders.details(handle).timer = schedule_expiry(handle);
+        if (_phase == TradingPhase::Auction)
+        {
+            // Orders accumulate until the uncross.
+            return OrderStatus::Accepted;
+        }
+
+        // The handle is released once the order is filled, what is left of an immediate order is found by id.
+        match_orders(order.side, trades);
+        if (is_immediate)
+        {
+            withdraw_order(id);
+        }
+        return OrderStatus::Accepted;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::reject_order(OrderHandle handle) -> void
+    {
+        if (_risk)
+        {
+            const auto& order = _orders[handle];
+            _risk->on_release(_orders.details(handle).account, order.side, order.total_quantity());
+        }
+        _orders.erase(handle);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::cancel_order(OrderId order_id) -> bool
+    {
+        const auto cancelled = withdraw_order(order_id);
+        publish_features();
+        return cancelled;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::withdraw_order(OrderId order_id) -> bool
+    {
+        const auto handle = _orders.find(order_id);
+        if (handle == invalid_handle)
+        {
+            // Cancels routinely race with fills, this is not an error.
+            return false;
+        }
+
+        remove_order(handle);
+        erase_entry(handle);
+        return true;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::modify_order(OrderId order_id, Price price, Quantity quantity) -> Trades
+    {
+        Trades trades;
+        modify_order(order_id, price, quantity, trades);
+        return trades;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::modify_order(OrderId order_id, Price price, Quantity quantity, Trades& trades) -> OrderStatus
+    {
+        const auto handle = _orders.find(order_id);
+        if (handle == invalid_handle)
+        {
+            return OrderStatus::UnknownOrder;
+        }
+
+        // The replacement only lives until the pool has copied it.
+        const auto& order   = _orders[handle];
+        const auto& details = _orders.details(handle);
+        Order       modified(order_id, details.type, order.side, price, quantity, order.flags, details.peak_quantity, details.stop_price, details.expiry);
+        modified.set_account(details.account);
+
+        withdraw_order(order_id);
+        return add_order(modified, trades);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::apply(const OrderCommand& command) -> Trades
+    {
+        Trades trades;
+        apply(command, trades);
+        return trades;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::apply(const OrderCommand& command, Trades& trades) -> OrderStatus
+    {
+        switch (command.type)
+        {
+            case CommandType::Add:
             {
-                auto& orders = _bids.at(price);
-                orders.erase(location);
-                if (orders.empty())
+                if (command.price == invalid_price && command.stop_price == invalid_price)
                 {
-                    _bids.erase(price);
+                    Order order(command.id, command.side, command.quantity);
+                    order.set_account(command.account);
+                    return add_order(order, trades);
                 }
-                break;
+                Order order(command.id, command.order_type, command.side, command.price, command.quantity, command.flags, command.peak_quantity, command.stop_price, command.expiry);
+                order.set_account(command.account);
+                return add_order(order, trades);
             }
-            default: Log::error("Unknown order side."); return;
+            case CommandType::Cancel: return cancel_order(command.id) ? OrderStatus::Accepted : OrderStatus::UnknownOrder;
+            case CommandType::Modify: return modify_order(command.id, command.price, command.quantity, trades);
+            default:                  Log::error("Unknown command type."); return OrderStatus::Invalid;
         }
-
-        _orders.erase(order_id);
     }
 
-    auto OrderBook::cancel_orders(OrderType order_type) -> void
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::accept_post_only(RestingOrder& order) -> bool
     {
-        for (auto it = _orders.begin(); it != _orders.end();)
+        // Only the best opposite price matters, so the check never walks the book.
+        if (order.side == Side::Buy)
         {
-            const auto& [order_id, entry] = *it;
-            const auto& [order, location] = entry;
-
-            if (order->type() != order_type)
+            const auto best = best_ask();
+            if (best == invalid_price || order.price < best)
+            {
+                return true;
+            }
+            if (_post_only_policy == PostOnlyPolicy::Reprice && best > 0)
+            {
+                order.price = best - 1;
+                return true;
+            }
+        }
+        else
+        {
+            const auto best = best_bid();
+            if (best == invalid_price || order.price > best)
             {
-                ++it;
-                continue;
+                return true;
             }
+            if (_post_only_policy == PostOnlyPolicy::Reprice && best + 1 != invalid_price)
+            {
+                order.price = best + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::remove_order(OrderHandle handle) -> void
+    {
+        const auto& order   = _orders[handle];
+        const auto& details = _orders.details(handle);
+        if (_risk)
+        {
+            _risk->on_release(details.account, order.side, order.total_quantity());
+        }
 
-            const auto price = order->price();
-            switch (order->side())
+        if (details.stop_price != invalid_price)
+        {
+            switch (order.side)
             {
-                case Side::Sell:
-                {
-                    auto& orders = _asks.at(price);
-                    orders.erase(location);
-                    if (orders.empty())
-                    {
-                        _asks.erase(price);
-                    }
-                    break;
-                }
-                case Side::Buy:
-                {
-                    auto& orders = _bids.at(price);
-                    orders.erase(location);
-                    if (orders.empty())
-                    {
-                        _bids.erase(price);
-                    }
-                    break;
-                }
-                default: break;
+                case Side::Sell: erase_stop_order(_sell_stops, _orders, handle); break;
+                case Side::Buy:  erase_stop_order(_buy_stops, _orders, handle); break;
+                default:         Log::error("Unknown order side."); break;
             }
+            return;
+        }
 
-            it = _orders.erase(it);
+        switch (order.side)
+        {
+            case Side::Sell: display(Side::Sell, order.price, erase_order(_asks, _orders, handle)); break;
+            case Side::Buy:  display(Side::Buy, order.price, erase_order(_bids, _orders, handle)); break;
+            default:         Log::error("Unknown order side."); break;
         }
     }
 
-    auto OrderBook::match_orders() -> Vector<Trade>
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::erase_entry(OrderHandle handle) -> void
     {
-        Vector<Trade> trades;
-        trades.reserve(_orders.size());
+        _timers.cancel(_orders.details(handle).timer);
+        _orders.erase(handle);
+    }
 
-        while (true)
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::park_stop_order(OrderHandle handle) -> void
+    {
+        auto&      details = _orders.details(handle);
+        const auto side    = _orders[handle].side;
+        _orders.push_back(side == Side::Buy ? _buy_stops[details.stop_price] : _sell_stops[details.stop_price], handle);
+        details.timer = schedule_expiry(handle);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::trigger_stop_orders(Trades& trades) -> void
+    {
+        // Cascades are handled iteratively: every activation may move the last price and arm further stops, which the
+        // next iteration picks up. Buy stops are released before sell stops, lowest (resp. highest) stop price first,
+        // and in arrival order within a stop price.
+        for (auto handle = pop_triggered_stop_order(); handle != invalid_handle; handle = pop_triggered_stop_order())
         {
-            if (_bids.empty() || _asks.empty())
+            _orders.details(handle).stop_price = invalid_price;
+            place_order(handle, trades);
+        }
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::pop_triggered_stop_order() -> OrderHandle
+    {
+        if (_last_price == invalid_price)
+        {
+            return invalid_handle;
+        }
+
+        const auto pop = [this](auto& stops) {
+            const auto it     = stops.begin();
+            const auto handle = it->second.head;
+            _orders.unlink(it->second, handle);
+            if (it->second.empty())
             {
-                // No more matches possible.
-                break;
+                stops.erase(it);
             }
 
-            auto& [bid_price, bid_orders] = *_bids.begin();
-            auto& [ask_price, ask_orders] = *_asks.begin();
+            // The expiry is scheduled again when the activated order is placed.
+            auto& details = _orders.details(handle);
+            _timers.cancel(details.timer);
+            details.timer = invalid_timer;
+            return handle;
+        };
+
+        // Only the first stop of each side needs to be looked at, so this is O(1) when nothing fires.
+        if (!_buy_stops.empty() && _buy_stops.begin()->first <= _last_price)
+        {
+            return pop(_buy_stops);
+        }
+        if (!_sell_stops.empty() && _sell_stops.begin()->first >= _last_price)
+        {
+            return pop(_sell_stops);
+        }
+        return invalid_handle;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::match_orders(Side aggressor, Trades& trades) -> void
+    {
+        // The book is never left crossed, so an order that crosses is alone at the best level of its side and matching
+        // sweeps the opposite levels with it.
+        if (aggressor == Side::Buy)
+        {
+            match_levels(_bids, _asks, aggressor, trades);
+        }
+        else
+        {
+            match_levels(_asks, _bids, aggressor, trades);
+        }
+    }
+
+    template <typename MatchingPolicy>
+    template <typename Incoming, typename Resting>
+    auto BasicOrderBook<MatchingPolicy>::match_levels(Incoming& incoming, Resting& resting, Side aggressor, Trades& trades) -> void
+    {
+        while (!incoming.empty() && !resting.empty())
+        {
+            const auto incoming_level = incoming.begin();
+            const auto resting_level  = resting.begin();
 
-            if (bid_price < ask_price)
+            if (incoming.key_comp()(resting_level->first, incoming_level->first))
             {
-                // No overlap in prices, can't match.
+                // No overlap in prices, the best resting price ranks ahead of the incoming one on its own side.
                 break;
             }
 
-            Vector<OrderId> filled_orders;
-            while (!bid_orders.empty() && !ask_orders.empty())
-            {
-                const auto& bid = bid_orders.front();
-                const auto& ask = ask_orders.front();
+            auto&      level   = incoming_level->second;
+            const auto handle  = level.orders.head;
+            auto&      order   = _orders[handle];
+            const auto id      = _orders.details(handle).id;
+            const auto account = _orders.details(handle).account;
 
-                const auto quantity = std::min(bid->remaining_quantity(), ask->remaining_quantity());
+            auto& passive = resting_level->second;
+            _matching.match(_orders, passive, order.remaining_quantity, [&](OrderHandle resting_handle, Quantity quantity) {
+                const auto price = _orders[resting_handle].price;
 
                 // Record the trade before modifying orders
-                trades.emplace_back(bid->id(), ask->id(), bid->price(), ask->price(), quantity);
+                const auto resting_id = _orders.details(resting_handle).id;
+                if (aggressor == Side::Buy)
+                {
+                    trades.emplace_back(id, resting_id, order.price, price, quantity);
+                }
+                else
+                {
+                    trades.emplace_back(resting_id, id, price, order.price, quantity);
+                }
+                if (_tape)
+                {
+                    _tape->append(trades.back(), price, aggressor == Side::Buy ? Aggressor::Buy : Aggressor::Sell, _now);
+                }
+                _last_price = price;
 
-                bid->fill(quantity);
-                ask->fill(quantity);
-                if (bid->is_filled())
+                display(order.side, order.price, fill_order(level, order, quantity));
+                if (_risk)
                 {
-                    _orders.erase(bid->id());
-                    bid_orders.pop_front();
+                    _risk->on_fill(account, aggressor, quantity, order.is_filled());
                 }
-                if (ask->is_filled())
+                if (_pnl)
                 {
-                    _orders.erase(ask->id());
-                    ask_orders.pop_front();
+                    _pnl->on_fill(account, aggressor, price, quantity, Liquidity::Taker, _now);
                 }
+                fill_resting_order(passive, resting_handle, price, quantity, Liquidity::Maker);
+            });
+
+            if (order.is_filled())
+            {
+                _orders.unlink(level.orders, handle);
+                erase_entry(handle);
+            }
+            else if (order.needs_replenish())
+            {
+                display(order.side, order.price, replenish_order(level, _orders, handle));
             }
 
-            if (bid_orders.empty())
+            if (passive.orders.empty())
             {
-                _bids.erase(bid_price);
+                resting.erase(resting_level);
             }
-            if (ask_orders.empty())
+            if (level.orders.empty())
             {
-                _asks.erase(ask_price);
+                incoming.erase(incoming_level);
             }
         }
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::fill_resting_order(Level& level, OrderHandle handle, Price price, Quantity quantity, Liquidity liquidity) -> void
+    {
+        auto&      order   = _orders[handle];
+        const auto account = _orders.details(handle).account;
+        display(order.side, order.price, fill_order(level, order, quantity));
+        if (_risk)
+        {
+            _risk->on_fill(account, order.side, quantity, order.is_filled());
+        }
+        if (_pnl)
+        {
+            _pnl->on_fill(account, order.side, price, quantity, liquidity, _now);
+        }
 
+        if (order.is_filled())
+        {
+            _orders.unlink(level.orders, handle);
+            erase_entry(handle);
+        }
+        else if (order.needs_replenish())
+        {
+            display(order.side, order.price, replenish_order(level, _orders, handle));
+        }
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::equilibrium() const noexcept -> AuctionEquilibrium
+    {
+        // Walks the crossed levels from both sides at once on their totals, like a matching pass that never touches an
+        // order. The volume is maximal at every price between the last bid and ask levels reached.
+        AuctionEquilibrium result(invalid_price, 0);
+
+        auto   bid      = _bids.begin();
+        auto   ask      = _asks.begin();
+        uint64 bid_left = bid != _bids.end() ? level_quantity(bid->second) : 0;
+        uint64 ask_left = ask != _asks.end() ? level_quantity(ask->second) : 0;
+        Price  low      = 0;
+        Price  high     = 0;
+
+        while (bid != _bids.end() && ask != _asks.end() && bid->first >= ask->first)
+        {
+            const auto quantity = std::min(bid_left, ask_left);
+            result.volume += quantity;
+            low  = ask->first;
+            high = bid->first;
+
+            bid_left -= quantity;
+            ask_left -= quantity;
+            if (bid_left == 0 && ++bid != _bids.end())
+            {
+                bid_left = level_quantity(bid->second);
+            }
+            if (ask_left == 0 && ++ask != _asks.end())
+            {
+                ask_left = level_quantity(ask->second);
+            }
+        }
+
+        if (result.volume > 0)
+        {
+            // Ties go to the price closest to the last trade, or to the middle of the range before the first one.
+            result.price = _last_price != invalid_price ? std::clamp(_last_price, low, high) : low + (high - low) / 2;
+        }
+        return result;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::start_auction() -> void
+    {
+        _phase = TradingPhase::Auction;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::uncross() -> Trades
+    {
+        Trades trades;
+        uncross(trades);
         return trades;
     }
 
-    auto OrderBook::cancel_gfd_if_needed() -> void
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::uncross(Trades& trades) -> void
     {
-        // When session is closed, expire all GFD orders once
-        if (!_gfd_expired_today && _session.is_close())
+        const auto [price, volume] = equilibrium();
+        _phase = _batch_interval > TimePoint::duration::zero() ? TradingPhase::Auction : TradingPhase::Continuous;
+
+        if (volume == 0)
+        {
+            return;
+        }
+
+        // Each side is filled on its own, best level first and within a level by the matching policy, then the two
+        // fill sequences are paired into trades at the single uncross price.
+        allocate_auction(_bids, price, volume, _bid_fills);
+        allocate_auction(_asks, price, volume, _ask_fills);
+
+        usize bid = 0;
+        usize ask = 0;
+        while (bid < _bid_fills.size() && ask < _ask_fills.size())
         {
-            cancel_orders(OrderType::GFD);
-            _gfd_expired_today = true;
-            Log::trace("Expired all GFD orders at market close");
+            auto& bid_fill = _bid_fills[bid];
+            auto& ask_fill = _ask_fills[ask];
+
+            const auto quantity = std::min(bid_fill.quantity, ask_fill.quantity);
+            trades.emplace_back(bid_fill.id, ask_fill.id, price, price, quantity);
+            if (_tape)
+            {
+                _tape->append(trades.back(), price, Aggressor::None, _now);
+            }
+
+            bid_fill.quantity -= quantity;
+            ask_fill.quantity -= quantity;
+            if (bid_fill.quantity == 0)
+            {
+                ++bid;
+            }
+            if (ask_fill.quantity == 0)
+            {
+                ++ask;
+            }
         }
 
-        // When session reopens, reset daily expiry flag
-        if (_gfd_expired_today && _session.is_open())
+        _last_price = price;
+        trigger_stop_orders(trades);
+        publish_features();
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::refresh_view() -> void
+    {
+        if (_view)
         {
-            _gfd_expired_today = false;
-            Log::trace("Reset GFD expiry state for new session");
+            publish_view();
         }
     }
+
+    template <typename MatchingPolicy>
+    template <typename Levels>
+    auto BasicOrderBook<MatchingPolicy>::allocate_auction(Levels& levels, Price price, uint64 volume, Vector<AuctionFill>& fills) -> void
+    {
+        fills.clear();
+        while (volume > 0)
+        {
+            ensure(!levels.empty(), "Auction volume exceeds the crossed quantity");
+
+            const auto it       = levels.begin();
+            auto&      level    = it->second;
+            const auto quantity = static_cast<Quantity>(std::min<uint64>(volume, static_cast<uint64>(level.visible_quantity) + level.hidden_quantity));
+
+            _matching.match(_orders, level, quantity, [&](OrderHandle handle, Quantity filled) {
+                fills.emplace_back(_orders.details(handle).id, filled);
+                fill_resting_order(level, handle, price, filled, Liquidity::Taker);
+            });
+            volume -= quantity;
+
+            if (level.orders.empty())
+            {
+                levels.erase(it);
+            }
+        }
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::advance_time(TimePoint now) -> Trades
+    {
+        Trades trades;
+        advance_time(now, trades);
+        return trades;
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::advance_time(TimePoint now, Trades& trades) -> void
+    {
+        if (now <= _now)
+        {
+            return;
+        }
+
+        advance_clock(now, trades);
+        publish_features();
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::advance_clock(TimePoint now, Trades& trades) -> void
+    {
+        if (now <= _now)
+        {
+            return;
+        }
+
+        const auto expire = [this](OrderHandle handle) { expire_order(handle); };
+
+        if (_batch_interval > TimePoint::duration::zero() && now >= _next_batch)
+        {
+            // Orders that expire before the batch do not take part in it. Batches with no new orders in between would
+            // not trade, so the missed ones are skipped.
+            _now = _next_batch;
+            _timers.advance(to_tick(_next_batch), expire);
+            uncross(trades);
+            _next_batch += ((now - _next_batch) / _batch_interval + 1) * _batch_interval;
+        }
+
+        _now = now;
+        _timers.advance(to_tick(now), expire);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::schedule_expiry(OrderHandle handle) -> TimerHandle
+    {
+        const auto& details = _orders.details(handle);
+
+        TimePoint expiry;
+        switch (details.type)
+        {
+            case OrderType::GTT: expiry = details.expiry; break;
+            case OrderType::GFD: expiry = _session.next_close(_now); break;
+            default:             return invalid_timer;
+        }
+
+        // Rounded up to the next tick, orders never expire early.
+        return _timers.insert(to_tick(expiry - TimePoint::duration(1)) + 1, handle);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::expire_order(OrderHandle handle) -> void
+    {
+        // The timer has already been released by the wheel, and a handle is never freed while its timer is pending.
+        _orders.details(handle).timer = invalid_timer;
+        remove_order(handle);
+        _orders.erase(handle);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::to_tick(TimePoint time_point) const noexcept -> uint64
+    {
+        const auto elapsed = time_point.time_since_epoch();
+        return elapsed.count() <= 0 ? 0 : static_cast<uint64>(elapsed / _timer_tick);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::display(Side side, Price price, int64 quantity) -> void
+    {
+        if (quantity == 0)
+        {
+            return;
+        }
+
+        _depth.add(side, price, quantity);
+        if (side == Side::Buy)
+        {
+            _touched_bid = _touched_bid == invalid_price ? price : std::max(_touched_bid, price);
+        }
+        else
+        {
+            _touched_ask = std::min(_touched_ask, price);
+        }
+        if (_consolidated)
+        {
+            _consolidated->update(_venue, side, price, quantity);
+        }
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::publish_features() -> void
+    {
+        if (_publisher)
+        {
+            publish_depth();
+        }
+        if (_view && _view->due(_now))
+        {
+            publish_view();
+        }
+        if (!_features)
+        {
+            return;
+        }
+
+        _features->on_book(_manual_clock ? _now : Clock::now(), top());
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::publish_depth() -> void
+    {
+        // Only a side whose displayed quantity changed at or inside its published levels is walked again, most
+        // operations happen further away and cost two comparisons.
+        const auto reached = [this](Side side) {
+            const auto price    = touched(side);
+            const auto boundary = _publisher->boundary(side);
+            return price != invalid_price && (boundary == invalid_price || (side == Side::Buy ? price >= boundary : price <= boundary));
+        };
+
+        // Staged levels better than the touched price did not change, the walk resumes at the touched price. Levels
+        // holding only hidden quantity are not displayed, like in infos().
+        const auto stage = [](const auto& levels, Price touched, std::span<SharedLevel> staged) {
+            usize count = 0;
+            while (count < staged.size() && staged[count].quantity > 0 && levels.key_comp()(staged[count].price, touched))
+            {
+                ++count;
+            }
+            for (auto it = levels.lower_bound(touched); it != levels.end() && count < staged.size(); ++it)
+            {
+                if (it->second.visible_quantity > 0)
+                {
+                    staged[count++] = SharedLevel(it->first, it->second.visible_quantity);
+                }
+            }
+            std::fill(staged.begin() + static_cast<ssize>(count), staged.end(), SharedLevel());
+        };
+
+        const auto bids = reached(Side::Buy);
+        const auto asks = reached(Side::Sell);
+        if (!bids && !asks)
+        {
+            clear_touched();
+            return;
+        }
+
+        if (bids)
+        {
+            stage(_bids, touched(Side::Buy), _publisher->stage(Side::Buy));
+        }
+        if (asks)
+        {
+            stage(_asks, touched(Side::Sell), _publisher->stage(Side::Sell));
+        }
+        clear_touched();
+        _publisher->commit(_manual_clock ? _now : Clock::now(), _last_price);
+    }
+
+    template <typename MatchingPolicy>
+    auto BasicOrderBook<MatchingPolicy>::publish_view() -> void
+    {
+        // Every slot held by a reader, the refresh stays due and is retried on the next operation.
+        auto* snapshot = _view->begin_update();
+        if (!snapshot)
+        {
+            return;
+        }
+
+        const auto limit = _view->levels() == 0 ? std::numeric_limits<usize>::max() : _view->levels();
+        const auto copy  = [limit](const auto& levels, Vector<SharedLevel>& staged) {
+            staged.clear();
+            for (auto it = levels.begin(); it != levels.end() && staged.size() < limit; ++it)
+            {
+                if (it->second.visible_quantity > 0)
+                {
+                    staged.push_back(SharedLevel(it->first, it->second.visible_quantity));
+                }
+            }
+        };
+
+        copy(_bids, snapshot->bids);
+        copy(_asks, snapshot->asks);
+        _view->end_update(_now);
+    }
+
+    template class BasicOrderBook<FifoMatching>;
+    template class BasicOrderBook<ProRataMatching>;
+    template class BasicOrderBook<LmmMatching>;
 }
@@ -0,0 +1,137 @@
+#include "order_book/order_pool.hpp"
+
+#include <bit>
+
+namespace flob
+{
+    namespace
+    {
+        constexpr usize min_index_capacity = 16;
+    }
+
+    OrderPool::OrderPool() noexcept
+        : _free(invalid_handle)
+        , _size(0)
+        , _index_shift(64)
+    {}
+
+    auto OrderPool::reserve(usize capacity, const PageConfig& pages) -> void
+    {
+        _orders.reserve(capacity);
+        _details.reserve(capacity);
+        prepare_pages(_orders.data(), _orders.capacity() * sizeof(RestingOrder), pages);
+        prepare_pages(_details.data(), _details.capacity() * sizeof(OrderDetails), pages);
+        if (capacity * 2 > _index.size())
+        {
+            rehash(std::bit_ceil(capacity * 2), pages);
+        }
+    }
+
+    auto OrderPool::insert(const Order& order) -> OrderHandle
+    {
+        if ((_size + 1) * 2 > _index.size())
+        {
+            rehash(std::max(min_index_capacity, _index.size() * 2));
+        }
+
+        const auto hot  = RestingOrder(order.price(), order.remaining_quantity(), order.reserve_quantity(), invalid_handle, invalid_handle, order.side(), order.flags());
+        const auto cold = OrderDetails(order.id(), order.expiry(), order.stop_price(), order.peak_quantity(), order.account(), invalid_timer, order.type());
+
+        OrderHandle handle;
+        if (_free != invalid_handle)
+        {
+            handle           = _free;
+            _free            = _orders[handle].next;
+            _orders[handle]  = hot;
+            _details[handle] = cold;
+        }
+        else
+        {
+            ensure(_orders.size() < invalid_handle, "Order pool is full");
+            handle = static_cast<OrderHandle>(_orders.size());
+            _orders.push_back(hot);
+            _details.push_back(cold);
+        }
+
+        auto slot = home(order.id());
+        while (_index[slot] != invalid_handle)
+        {
+            slot = (slot + 1) & (_index.size() - 1);
+        }
+        _index[slot] = handle;
+
+        ++_size;
+        return handle;
+    }
+
+    auto OrderPool::erase(OrderHandle handle) noexcept -> void
+    {
+        const auto mask = _index.size() - 1;
+
+        auto slot = home(_details[handle].id);
+        while (_index[slot] != handle)
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        // Backward shift deletion: later entries of the probe run move into the hole when their home slot allows it,
+        // so lookups never need tombstones.
+        for (auto next = (slot + 1) & mask; _index[next] != invalid_handle; next = (next + 1) & mask)
+        {
+            const auto wanted = home(_details[_index[next]].id);
+            if (((next - wanted) & mask) >= ((next - slot) & mask))
+            {
+                _index[slot] = _index[next];
+                slot         = next;
+            }
+        }
+        _index[slot] = invalid_handle;
+
+        _orders[handle].next = _free;
+        _free                = handle;
+        --_size;
+    }
+
+    auto OrderPool::find(OrderId id) const noexcept -> OrderHandle
+    {
+        if (_size == 0)
+        {
+            return invalid_handle;
+        }
+
+        for (auto slot = home(id);; slot = (slot + 1) & (_index.size() - 1))
+        {
+            const auto handle = _index[slot];
+            if (handle == invalid_handle || _details[handle].id == id)
+            {
+                return handle;
+            }
+        }
+    }
+
+    auto OrderPool::rehash(usize capacity, const PageConfig& pages) -> void
+    {
+        // Prepared before it is filled, so that the first touch already lands on huge pages.
+        Vector<OrderHandle> index;
+        index.reserve(capacity);
+        prepare_pages(index.data(), capacity * sizeof(OrderHandle), pages);
+        index.resize(capacity, invalid_handle);
+        _index_shift = static_cast<uint32>(64 - std::countr_zero(capacity));
+
+        for (const auto handle : _index)
+        {
+            if (handle == invalid_handle)
+            {
+                continue;
+            }
+
+            auto slot = home(_details[handle].id);
+            while (index[slot] != invalid_handle)
+            {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            index[slot] = handle;
+        }
+        _index = std::move(index);
+    }
+}
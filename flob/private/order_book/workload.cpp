@@ -0,0 +1,145 @@
+#include "order_book/workload.hpp"
+
+#include "order_book/order.hpp"
+
+#include <cmath>
+
+namespace flob
+{
+    WorkloadGenerator::WorkloadGenerator(const WorkloadConfig& config)
+        : _config(config)
+        , _random(config.seed)
+        , _next_id(1)
+        , _mid_price(std::max(config.mid_price, static_cast<Price>(config.max_distance + 1)))
+        , _time(0.0)
+        , _excitation(0.0)
+    {
+        _live_orders.reserve(config.max_live_orders);
+    }
+
+    auto WorkloadGenerator::next() -> OrderCommand
+    {
+        const auto timestamp = next_timestamp();
+
+        if (_random.bernoulli(_config.mid_move_rate))
+        {
+            _mid_price = _random.bernoulli(0.5) ? _mid_price + 1 : std::max(_mid_price - 1, static_cast<Price>(_config.max_distance + 1));
+        }
+
+        const auto& mix   = _config.mix;
+        const auto  total = mix.add + mix.cancel + mix.modify + mix.ioc + mix.market;
+        const auto  pick  = _random.real() * total;
+
+        const auto side = _random.bernoulli(0.5) ? Side::Buy : Side::Sell;
+
+        // Cancels and modifies fall back to adds while there is nothing to target.
+        if (pick < mix.cancel)
+        {
+            return _live_orders.empty() ? add_limit_order(timestamp, side) : cancel_live_order(timestamp);
+        }
+        if (pick < mix.cancel + mix.modify)
+        {
+            if (_live_orders.empty())
+            {
+                return add_limit_order(timestamp, side);
+            }
+
+            const auto& order = _live_orders[_random.uniform(_live_orders.size())];
+            return OrderCommand(timestamp, order.id, next_limit_price(order.side), next_quantity(), CommandType::Modify, OrderType::GTC, order.side);
+        }
+        if (pick < mix.cancel + mix.modify + mix.ioc)
+        {
+            // Marketable limit a few ticks through the mid.
+            const auto distance = static_cast<Price>(_random.uniform(4));
+            const auto price    = side == Side::Buy ? _mid_price + distance : _mid_price - distance;
+            return OrderCommand(timestamp, OrderId(_next_id++), price, next_quantity(), CommandType::Add, OrderType::IOC, side);
+        }
+        if (pick < mix.cancel + mix.modify + mix.ioc + mix.market)
+        {
+            return OrderCommand(timestamp, OrderId(_next_id++), invalid_price, next_quantity(), CommandType::Add, OrderType::None, side);
+        }
+
+        return add_limit_order(timestamp, side);
+    }
+
+    auto WorkloadGenerator::generate(usize count) -> CommandBuffer
+    {
+        CommandBuffer buffer;
+        generate(buffer, count);
+        return buffer;
+    }
+
+    auto WorkloadGenerator::generate(CommandBuffer& buffer, usize count) -> void
+    {
+        buffer.reserve(buffer.size() + count);
+        for (usize i = 0; i < count; ++i)
+        {
+            buffer.push_back(next());
+        }
+    }
+
+    auto WorkloadGenerator::add_limit_order(uint64 timestamp, Side side) -> OrderCommand
+    {
+        if (!_live_orders.empty() && _live_orders.size() >= _config.max_live_orders)
+        {
+            return cancel_live_order(timestamp);
+        }
+
+        const auto id = OrderId(_next_id++);
+        _live_orders.push_back(LiveOrder(id, side));
+
+        auto command = OrderCommand(timestamp, id, next_limit_price(side), next_quantity(), CommandType::Add, OrderType::GTC, side);
+        if (_random.bernoulli(_config.iceberg_rate))
+        {
+            command.quantity *= _config.iceberg_slices;
+            command.peak_quantity = command.quantity / _config.iceberg_slices;
+        }
+        return command;
+    }
+
+    auto WorkloadGenerator::cancel_live_order(uint64 timestamp) -> OrderCommand
+    {
+        const auto index = _random.uniform(_live_orders.size());
+        const auto order = _live_orders[index];
+
+        _live_orders[index] = _live_orders.back();
+        _live_orders.pop_back();
+
+        return OrderCommand(timestamp, order.id, 0, 0, CommandType::Cancel, OrderType::None, order.side);
+    }
+
+    auto WorkloadGenerator::next_timestamp() -> uint64
+    {
+        // Ogata thinning: between events the intensity only decays, so its current value bounds it until the next event.
+        const auto& arrivals = _config.arrivals;
+        const auto  jump     = arrivals.excitation * arrivals.decay;
+
+        while (true)
+        {
+            const auto bound = arrivals.baseline_rate + _excitation;
+            const auto wait  = _random.exponential(bound);
+
+            _time += wait;
+            _excitation *= std::exp(-arrivals.decay * wait);
+
+            if (_random.real() * bound <= arrivals.baseline_rate + _excitation)
+            {
+                _excitation += jump;
+                break;
+            }
+        }
+
+        return static_cast<uint64>(_time * 1e9);
+    }
+
+    auto WorkloadGenerator::next_quantity() -> Quantity
+    {
+        return static_cast<Quantity>(_random.range(_config.min_qty, _config.max_qty));
+    }
+
+    auto WorkloadGenerator::next_limit_price(Side side) -> Price
+    {
+        const auto distance = 1 + _random.geometric(_config.distance_decay, _config.max_distance - 1);
+        return side == Side::Buy ? _mid_price - distance : _mid_price + distance;
+    }
+}
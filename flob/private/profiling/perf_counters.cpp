@@ -0,0 +1,180 @@
+#include "profiling/perf_counters.hpp"
+
+#include "log/log.hpp"
+
+#include <algorithm>
+
+#if defined(__linux__)
+    #include <cerrno>
+    #include <cstring>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace flob
+{
+    PerfCounters::PerfCounters(PerfCounters&& other) noexcept
+    {
+        std::copy(std::begin(other._fds), std::end(other._fds), std::begin(_fds));
+        std::fill(std::begin(other._fds), std::end(other._fds), -1);
+    }
+
+    auto PerfCounters::operator=(PerfCounters&& other) noexcept -> PerfCounters&
+    {
+        if (this != &other)
+        {
+            close();
+            std::copy(std::begin(other._fds), std::end(other._fds), std::begin(_fds));
+            std::fill(std::begin(other._fds), std::end(other._fds), -1);
+        }
+        return *this;
+    }
+
+    PerfCounters::~PerfCounters() noexcept
+    {
+        close();
+    }
+
+    auto PerfCounters::available() const noexcept -> bool
+    {
+        return std::any_of(std::begin(_fds), std::end(_fds), [](int32 fd) { return fd >= 0; });
+    }
+
+    auto PerfCounters::has(PerfEvent event) const noexcept -> bool
+    {
+        return _fds[static_cast<usize>(event)] >= 0;
+    }
+
+#if defined(__linux__)
+
+    namespace
+    {
+        struct EventType
+        {
+            uint32 type;
+            uint64 config;
+        };
+
+        // Indexed by PerfEvent.
+        constexpr EventType event_types[perf_event_count] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        };
+
+        // Layout of a read() with PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING.
+        struct Reading
+        {
+            uint64 value;
+            uint64 time_enabled;
+            uint64 time_running;
+        };
+
+        auto open_event(const EventType& event) noexcept -> int32
+        {
+            perf_event_attr attributes;
+            std::memset(&attributes, 0, sizeof(attributes));
+            attributes.size           = sizeof(attributes);
+            attributes.type           = event.type;
+            attributes.config         = event.config;
+            attributes.disabled       = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv     = 1;
+            attributes.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            // The calling thread, on whichever CPU it runs.
+            return static_cast<int32>(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+        }
+    }
+
+    PerfCounters::PerfCounters() noexcept
+    {
+        int32 error = 0;
+        for (usize i = 0; i < perf_event_count; ++i)
+        {
+            _fds[i] = open_event(event_types[i]);
+            error   = _fds[i] < 0 && error == 0 ? errno : error;
+        }
+
+        if (!has(PerfEvent::Cycles))
+        {
+            Log::warn("Hardware counters are not available: {}. Check perf_event_paranoid, or whether the machine exposes a PMU.", std::strerror(error));
+        }
+    }
+
+    auto PerfCounters::start() noexcept -> void
+    {
+        for (const auto fd : _fds)
+        {
+            if (fd >= 0)
+            {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    auto PerfCounters::stop() noexcept -> PerfSample
+    {
+        // Every event is stopped before any is read, so that reading does not count.
+        for (const auto fd : _fds)
+        {
+            if (fd >= 0)
+            {
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+
+        PerfSample sample;
+        for (usize i = 0; i < perf_event_count; ++i)
+        {
+            Reading reading;
+            if (_fds[i] < 0 || ::read(_fds[i], &reading, sizeof(reading)) != sizeof(reading) || reading.time_running == 0)
+            {
+                continue;
+            }
+
+            // Scaled up by the share of the interval during which the event had a hardware counter.
+            const auto scale = static_cast<float64>(reading.time_enabled) / static_cast<float64>(reading.time_running);
+            sample.values[i] = static_cast<uint64>(static_cast<float64>(reading.value) * scale);
+            sample.available |= 1u << i;
+        }
+        return sample;
+    }
+
+    auto PerfCounters::close() noexcept -> void
+    {
+        for (auto& fd : _fds)
+        {
+            if (fd >= 0)
+            {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    }
+
+#else
+
+    PerfCounters::PerfCounters() noexcept
+    {
+        std::fill(std::begin(_fds), std::end(_fds), -1);
+    }
+
+    auto PerfCounters::start() noexcept -> void {}
+
+    auto PerfCounters::stop() noexcept -> PerfSample
+    {
+        return {};
+    }
+
+    auto PerfCounters::close() noexcept -> void {}
+
+#endif
+}
@@ -0,0 +1,214 @@
+#include "protocol/order_entry.hpp"
+
+namespace flob
+{
+    namespace
+    {
+        // Writes the header and returns the start of the message, nullptr when it does not fit.
+        auto begin_message(std::span<std::byte> buffer, wire::MessageType type) noexcept -> std::byte*
+        {
+            const auto size = wire::message_size(type);
+            if (buffer.size() < size)
+            {
+                return nullptr;
+            }
+
+            wire::store(buffer.data(), static_cast<uint16>(size));
+            wire::store(buffer.data() + sizeof(uint16), type);
+            return buffer.data();
+        }
+
+        // Enum fields come straight from the client, values the book does not know must not reach it.
+        auto is_valid(Side side) noexcept -> bool
+        {
+            return side == Side::Buy || side == Side::Sell;
+        }
+
+        auto is_valid(OrderType type) noexcept -> bool
+        {
+            return static_cast<uint8>(type) <= static_cast<uint8>(OrderType::GTT);
+        }
+
+        auto is_valid(OrderFlags flags) noexcept -> bool
+        {
+            const auto known = OrderFlags::Iceberg | OrderFlags::PostOnly | OrderFlags::Hidden;
+            return (static_cast<uint8>(flags) & ~static_cast<uint8>(known)) == 0;
+        }
+    }
+
+    auto next_message(std::span<const std::byte> input, bool& malformed) noexcept -> std::optional<MessageView>
+    {
+        if (input.size() < wire::header_size)
+        {
+            return std::nullopt;
+        }
+
+        // Every type has a fixed size, a length that disagrees with it means the stream is corrupt.
+        const auto length   = wire::load<uint16>(input.data());
+        const auto type     = wire::load<wire::MessageType>(input.data() + sizeof(uint16));
+        const auto expected = wire::message_size(type);
+        if (expected == 0 || length != expected)
+        {
+            Log::error("Malformed message of type {} and length {}.", static_cast<uint8>(type), length);
+            malformed = true;
+            return std::nullopt;
+        }
+
+        if (input.size() < length)
+        {
+            return std::nullopt;
+        }
+        return MessageView(input.first(length));
+    }
+
+    auto decode_command(const MessageView& message, OrderCommand& command) noexcept -> bool
+    {
+        const auto offset = wire::header_size;
+        switch (message.type())
+        {
+            case wire::MessageType::EnterOrder:
+            {
+                const auto side  = message.field<Side>(offset + 36);
+                const auto type  = message.field<OrderType>(offset + 37);
+                const auto flags = message.field<OrderFlags>(offset + 38);
+                if (!is_valid(side) || !is_valid(type) || !is_valid(flags))
+                {
+                    Log::error("Malformed order entry: side {}, order type {}, flags {}.", static_cast<uint8>(side), static_cast<uint8>(type), static_cast<uint8>(flags));
+                    return false;
+                }
+
+                const auto expiry = std::chrono::nanoseconds(message.field<int64>(offset + 24));
+
+                command               = OrderCommand(0, OrderId(message.field<uint64>(offset)), message.field<Price>(offset + 8), message.field<Quantity>(offset + 12),
+                                                     CommandType::Add, type, side);
+                command.peak_quantity = message.field<Quantity>(offset + 16);
+                command.stop_price    = message.field<Price>(offset + 20);
+                command.expiry        = TimePoint(std::chrono::duration_cast<TimePoint::duration>(expiry));
+                command.account       = message.field<AccountId>(offset + 32);
+                command.flags         = flags;
+                return true;
+            }
+            case wire::MessageType::CancelOrder:
+            {
+                command = OrderCommand(0, OrderId(message.field<uint64>(offset)), 0, 0, CommandType::Cancel, OrderType::None, Side::Buy);
+                return true;
+            }
+            case wire::MessageType::ReplaceOrder:
+            {
+                command = OrderCommand(0, OrderId(message.field<uint64>(offset)), message.field<Price>(offset + 8), message.field<Quantity>(offset + 12),
+                                       CommandType::Modify, OrderType::None, Side::Buy);
+                return true;
+            }
+            default: return false;
+        }
+    }
+
+    auto encode_command(std::span<std::byte> buffer, const OrderCommand& command) noexcept -> usize
+    {
+        const auto offset = wire::header_size;
+        switch (command.type)
+        {
+            case CommandType::Add:
+            {
+                auto* data = begin_message(buffer, wire::MessageType::EnterOrder);
+                if (!data)
+                {
+                    return 0;
+                }
+
+                const auto expiry = std::chrono::duration_cast<std::chrono::nanoseconds>(command.expiry.time_since_epoch());
+                wire::store(data + offset, static_cast<uint64>(command.id));
+                wire::store(data + offset + 8, command.price);
+                wire::store(data + offset + 12, command.quantity);
+                wire::store(data + offset + 16, command.peak_quantity);
+                wire::store(data + offset + 20, command.stop_price);
+                wire::store(data + offset + 24, static_cast<int64>(expiry.count()));
+                wire::store(data + offset + 32, command.account);
+                wire::store(data + offset + 36, command.side);
+                wire::store(data + offset + 37, command.order_type);
+                wire::store(data + offset + 38, command.flags);
+                return wire::enter_order_size;
+            }
+            case CommandType::Cancel:
+            {
+                auto* data = begin_message(buffer, wire::MessageType::CancelOrder);
+                if (!data)
+                {
+                    return 0;
+                }
+
+                wire::store(data + offset, static_cast<uint64>(command.id));
+                return wire::cancel_order_size;
+            }
+            case CommandType::Modify:
+            {
+                auto* data = begin_message(buffer, wire::MessageType::ReplaceOrder);
+                if (!data)
+                {
+                    return 0;
+                }
+
+                wire::store(data + offset, static_cast<uint64>(command.id));
+                wire::store(data + offset + 8, command.price);
+                wire::store(data + offset + 12, command.quantity);
+                return wire::replace_order_size;
+            }
+            default: Log::error("Unknown command type."); return 0;
+        }
+    }
+
+    auto encode_execution(std::span<std::byte> buffer, const Trade& trade) noexcept -> usize
+    {
+        auto* data = begin_message(buffer, wire::MessageType::Executed);
+        if (!data)
+        {
+            return 0;
+        }
+
+        const auto offset = wire::header_size;
+        wire::store(data + offset, static_cast<uint64>(trade.bid_id));
+        wire::store(data + offset + 8, static_cast<uint64>(trade.ask_id));
+        wire::store(data + offset + 16, trade.bid_price);
+        wire::store(data + offset + 20, trade.ask_price);
+        wire::store(data + offset + 24, trade.quantity);
+        return wire::executed_size;
+    }
+
+    auto encode_cancel_result(std::span<std::byte> buffer, OrderId order_id, bool cancelled) noexcept -> usize
+    {
+        auto* data = begin_message(buffer, wire::MessageType::CancelResult);
+        if (!data)
+        {
+            return 0;
+        }
+
+        wire::store(data + wire::header_size, static_cast<uint64>(order_id));
+        wire::store(data + wire::header_size + 8, static_cast<uint8>(cancelled));
+        return wire::cancel_result_size;
+    }
+
+    auto encode_accepted(std::span<std::byte> buffer, OrderId order_id) noexcept -> usize
+    {
+        auto* data = begin_message(buffer, wire::MessageType::Accepted);
+        if (!data)
+        {
+            return 0;
+        }
+
+        wire::store(data + wire::header_size, static_cast<uint64>(order_id));
+        return wire::accepted_size;
+    }
+
+    auto encode_rejected(std::span<std::byte> buffer, OrderId order_id, OrderStatus reason) noexcept -> usize
+    {
+        auto* data = begin_message(buffer, wire::MessageType::Rejected);
+        if (!data)
+        {
+            return 0;
+        }
+
+        wire::store(data + wire::header_size, static_cast<uint64>(order_id));
+        wire::store(data + wire::header_size + 8, reason);
+        return wire::rejected_size;
+    }
+}
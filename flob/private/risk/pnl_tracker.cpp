@@ -0,0 +1,107 @@
+#include "risk/pnl_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace flob
+{
+    PnlTracker::PnlTracker(const PnlConfig& config)
+        : _config(config)
+        , _bucket(-1)
+    {}
+
+    auto PnlTracker::unrealized(AccountId account, float64 mark) const noexcept -> float64
+    {
+        if (!is_tracked(account))
+        {
+            return 0.0;
+        }
+
+        const auto& pnl = _accounts[account];
+        return static_cast<float64>(pnl.position) * (mark - pnl.average_cost);
+    }
+
+    auto PnlTracker::total(AccountId account, float64 mark) const noexcept -> float64
+    {
+        if (!is_tracked(account))
+        {
+            return 0.0;
+        }
+
+        const auto& pnl = _accounts[account];
+        return pnl.realized + unrealized(account, mark) - pnl.fees + pnl.rebates;
+    }
+
+    auto PnlTracker::on_fill(AccountId account, Side side, Price price, Quantity quantity, Liquidity liquidity, TimePoint time) -> void
+    {
+        if (account == invalid_account)
+        {
+            return;
+        }
+
+        const auto bucket = static_cast<int64>(time.time_since_epoch() / _config.bucket);
+        if (bucket != _bucket)
+        {
+            flush();
+            _bucket = bucket;
+        }
+
+        if (account >= _accounts.size())
+        {
+            _accounts.resize(account + 1);
+            _traded.resize(account + 1, false);
+        }
+        if (!_traded[account])
+        {
+            _traded[account] = true;
+            _traded_accounts.push_back(account);
+        }
+
+        auto&      pnl     = _accounts[account];
+        const auto size    = std::abs(pnl.position);
+        const auto is_long = pnl.position > 0;
+        const auto is_buy  = side == Side::Buy;
+
+        if (pnl.position == 0 || is_long == is_buy)
+        {
+            pnl.average_cost = (pnl.average_cost * size + static_cast<float64>(price) * quantity) / (size + quantity);
+        }
+        else
+        {
+            // Reducing: the closed part realizes against the average cost, any excess opens at the fill price.
+            const auto closed = std::min(static_cast<int64>(quantity), size);
+            pnl.realized += static_cast<float64>(closed) * (price - pnl.average_cost) * (is_long ? 1.0 : -1.0);
+            if (quantity > size)
+            {
+                pnl.average_cost = price;
+            }
+        }
+        pnl.position += is_buy ? static_cast<int64>(quantity) : -static_cast<int64>(quantity);
+        pnl.volume += quantity;
+
+        if (liquidity == Liquidity::Maker)
+        {
+            pnl.rebates += _config.maker_rebate * quantity;
+        }
+        else
+        {
+            pnl.fees += _config.taker_fee * quantity;
+        }
+    }
+
+    auto PnlTracker::flush() -> void
+    {
+        const auto start = TimePoint(std::chrono::duration_cast<TimePoint::duration>(_bucket * _config.bucket));
+        for (const auto account : _traded_accounts)
+        {
+            _buckets.emplace_back(start, account, _accounts[account]);
+            _traded[account] = false;
+        }
+        _traded_accounts.clear();
+    }
+
+    auto PnlTracker::clear_buckets() noexcept -> void
+    {
+        _buckets.clear();
+    }
+}
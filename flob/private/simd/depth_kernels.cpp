@@ -0,0 +1,240 @@
+#include "simd/depth_kernels.hpp"
+
+// The AVX2 kernels are compiled for AVX2 function by function, so that the library itself still runs on any x86-64
+// CPU and only calls them after checking the CPU. Other compilers and targets get the scalar kernels only.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define FLOB_AVX2_KERNELS 1
+    #include <immintrin.h>
+#else
+    #define FLOB_AVX2_KERNELS 0
+#endif
+
+namespace flob
+{
+    namespace
+    {
+        //--------------------------------------------------------------------------------------------------------------
+        // Scalar
+        //--------------------------------------------------------------------------------------------------------------
+
+        auto sum_scalar(const uint32* quantities, usize count) noexcept -> uint64
+        {
+            uint64 total = 0;
+            for (usize i = 0; i < count; ++i)
+            {
+                total += quantities[i];
+            }
+            return total;
+        }
+
+        auto prefix_sum_scalar(const uint32* quantities, uint64* cumulative, usize count) noexcept -> void
+        {
+            uint64 total = 0;
+            for (usize i = 0; i < count; ++i)
+            {
+                total += quantities[i];
+                cumulative[i] = total;
+            }
+        }
+
+        auto find_cumulative_scalar(const uint32* quantities, usize count, uint64 threshold) noexcept -> usize
+        {
+            uint64 total = 0;
+            for (usize i = 0; i < count; ++i)
+            {
+                total += quantities[i];
+                if (total >= threshold)
+                {
+                    return i;
+                }
+            }
+            return count;
+        }
+
+        auto dot_scalar(const uint32* prices, const uint32* quantities, usize count) noexcept -> uint64
+        {
+            uint64 total = 0;
+            for (usize i = 0; i < count; ++i)
+            {
+                total += static_cast<uint64>(prices[i]) * quantities[i];
+            }
+            return total;
+        }
+
+        constexpr DepthKernels scalar_kernels = {
+            SimdLevel::Scalar, sum_scalar, prefix_sum_scalar, find_cumulative_scalar, dot_scalar,
+        };
+
+#if FLOB_AVX2_KERNELS
+
+        //--------------------------------------------------------------------------------------------------------------
+        // AVX2, 8 quantities per 256-bit register, widened to two registers of 4 64-bit lanes to accumulate
+        //--------------------------------------------------------------------------------------------------------------
+
+        __attribute__((target("avx2"))) inline auto load8(const uint32* values) noexcept -> __m256i
+        {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+        }
+
+        __attribute__((target("avx2"))) inline auto horizontal_sum(__m256i values) noexcept -> uint64
+        {
+            const auto half = _mm_add_epi64(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+            return static_cast<uint64>(_mm_cvtsi128_si64(_mm_add_epi64(half, _mm_unpackhi_epi64(half, half))));
+        }
+
+        // Sum of 8 quantities in 4 64-bit lanes. Interleaving with zeros widens them without crossing 128-bit lanes,
+        // which the order of a sum does not care about.
+        __attribute__((target("avx2"))) inline auto widen_sum8(__m256i values) noexcept -> __m256i
+        {
+            const auto zero = _mm256_setzero_si256();
+            return _mm256_add_epi64(_mm256_unpacklo_epi32(values, zero), _mm256_unpackhi_epi32(values, zero));
+        }
+
+        __attribute__((target("avx2"))) auto sum_avx2(const uint32* quantities, usize count) noexcept -> uint64
+        {
+            // Two accumulators to overlap the adds of consecutive blocks.
+            auto  first  = _mm256_setzero_si256();
+            auto  second = _mm256_setzero_si256();
+            usize i      = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                first  = _mm256_add_epi64(first, widen_sum8(load8(quantities + i)));
+                second = _mm256_add_epi64(second, widen_sum8(load8(quantities + i + 8)));
+            }
+            for (; i + 8 <= count; i += 8)
+            {
+                first = _mm256_add_epi64(first, widen_sum8(load8(quantities + i)));
+            }
+            return horizontal_sum(_mm256_add_epi64(first, second)) + sum_scalar(quantities + i, count - i);
+        }
+
+        // Inclusive prefix sum of 4 quantities, widened to 64 bits.
+        __attribute__((target("avx2"))) inline auto prefix4(const uint32* quantities) noexcept -> __m256i
+        {
+            auto values = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(quantities)));
+
+            // Within each 128-bit lane, then the last sum of the low lane into both of the high lane.
+            values         = _mm256_add_epi64(values, _mm256_slli_si256(values, 8));
+            const auto low = _mm256_permute4x64_epi64(values, 0b01'01'00'00);
+            return _mm256_add_epi64(values, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0b1111'0000));
+        }
+
+        __attribute__((target("avx2"))) auto prefix_sum_avx2(const uint32* quantities, uint64* cumulative, usize count) noexcept -> void
+        {
+            // Blocks of 8 are summed on their own, so only the scalar carry between blocks is a dependency chain.
+            uint64 carry = 0;
+            usize  i     = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const auto first  = prefix4(quantities + i);
+                auto       second = prefix4(quantities + i + 4);
+                second            = _mm256_add_epi64(second, _mm256_permute4x64_epi64(first, 0b11'11'11'11));
+
+                const auto offset = _mm256_set1_epi64x(static_cast<int64>(carry));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(cumulative + i), _mm256_add_epi64(first, offset));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(cumulative + i + 4), _mm256_add_epi64(second, offset));
+                carry += static_cast<uint64>(_mm256_extract_epi64(second, 3));
+            }
+            for (; i < count; ++i)
+            {
+                carry += quantities[i];
+                cumulative[i] = carry;
+            }
+        }
+
+        __attribute__((target("avx2"))) auto find_cumulative_avx2(const uint32* quantities, usize count, uint64 threshold) noexcept -> usize
+        {
+            // Whole blocks of 16 are skipped while the total stays below the threshold, the block that reaches it is
+            // searched level by level.
+            uint64 total = 0;
+            usize  i     = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const auto block = horizontal_sum(_mm256_add_epi64(widen_sum8(load8(quantities + i)), widen_sum8(load8(quantities + i + 8))));
+                if (total + block >= threshold)
+                {
+                    break;
+                }
+                total += block;
+            }
+            for (; i < count; ++i)
+            {
+                total += quantities[i];
+                if (total >= threshold)
+                {
+                    return i;
+                }
+            }
+            return count;
+        }
+
+        // Products of the even and of the odd 32-bit elements of 8 prices and quantities, as 4 64-bit lanes each.
+        // _mm256_mul_epu32 only multiplies the even elements, the odd ones are shifted down to get theirs.
+        __attribute__((target("avx2"))) inline auto dot8(const uint32* prices, const uint32* quantities) noexcept -> __m256i
+        {
+            const auto price    = load8(prices);
+            const auto quantity = load8(quantities);
+            const auto even     = _mm256_mul_epu32(price, quantity);
+            const auto odd      = _mm256_mul_epu32(_mm256_srli_epi64(price, 32), _mm256_srli_epi64(quantity, 32));
+            return _mm256_add_epi64(even, odd);
+        }
+
+        __attribute__((target("avx2"))) auto dot_avx2(const uint32* prices, const uint32* quantities, usize count) noexcept -> uint64
+        {
+            auto  first  = _mm256_setzero_si256();
+            auto  second = _mm256_setzero_si256();
+            usize i      = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                first  = _mm256_add_epi64(first, dot8(prices + i, quantities + i));
+                second = _mm256_add_epi64(second, dot8(prices + i + 8, quantities + i + 8));
+            }
+            for (; i + 8 <= count; i += 8)
+            {
+                first = _mm256_add_epi64(first, dot8(prices + i, quantities + i));
+            }
+            return horizontal_sum(_mm256_add_epi64(first, second)) + dot_scalar(prices + i, quantities + i, count - i);
+        }
+
+        constexpr DepthKernels avx2_kernels = {
+            SimdLevel::Avx2, sum_avx2, prefix_sum_avx2, find_cumulative_avx2, dot_avx2,
+        };
+
+        auto detect() noexcept -> SimdLevel
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Scalar;
+        }
+
+#else
+
+        auto detect() noexcept -> SimdLevel
+        {
+            return SimdLevel::Scalar;
+        }
+
+#endif
+    }
+
+    auto simd_level() noexcept -> SimdLevel
+    {
+        static const auto level = detect();
+        return level;
+    }
+
+    auto depth_kernels() noexcept -> const DepthKernels&
+    {
+        return depth_kernels(simd_level());
+    }
+
+    auto depth_kernels(SimdLevel level) noexcept -> const DepthKernels&
+    {
+#if FLOB_AVX2_KERNELS
+        if (level == SimdLevel::Avx2 && simd_level() == SimdLevel::Avx2)
+        {
+            return avx2_kernels;
+        }
+#endif
+        return scalar_kernels;
+    }
+}
@@ -0,0 +1,117 @@
+#include "simulation/agents.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace flob
+{
+    namespace
+    {
+        auto poisson_delay(Random& random, float64 rate) -> std::chrono::nanoseconds
+        {
+            return std::chrono::nanoseconds(static_cast<int64>(random.exponential(rate) * 1e9) + 1);
+        }
+
+        auto draw_quantity(Random& random, Quantity min, Quantity max) -> Quantity
+        {
+            return static_cast<Quantity>(random.range(min, max));
+        }
+    }
+
+    auto market_maker(MarketSimulator& simulator, AgentId agent, MarketMakerConfig config) -> AgentTask
+    {
+        OrderId bid_id;
+        OrderId ask_id;
+        Price   bid_price = invalid_price;
+        Price   ask_price = invalid_price;
+        int64   quoted    = 0;  // Position when the quotes were sent
+
+        while (true)
+        {
+            const auto data = co_await simulator.market_data(agent);
+
+            const auto mid = data.top.mid_price();
+            if (std::isnan(mid))
+            {
+                continue;
+            }
+
+            const auto position = simulator.position(agent);
+            const auto center   = static_cast<int64>(std::llround(mid - config.skew * static_cast<float64>(position)));
+            const auto bid      = position < config.max_position ? static_cast<Price>(std::max<int64>(center - config.half_spread, 1)) : invalid_price;
+            const auto ask      = position > -config.max_position ? static_cast<Price>(center + config.half_spread) : invalid_price;
+
+            // Quotes that did not move keep their time priority, unless a fill may have taken them out.
+            const auto refresh = position != quoted;
+            quoted             = position;
+            if (bid != bid_price || refresh)
+            {
+                if (bid_price != invalid_price)
+                {
+                    simulator.cancel(agent, bid_id);
+                }
+                if (bid != invalid_price)
+                {
+                    bid_id = simulator.submit(agent, OrderType::GTC, Side::Buy, bid, config.quantity);
+                }
+                bid_price = bid;
+            }
+            if (ask != ask_price || refresh)
+            {
+                if (ask_price != invalid_price)
+                {
+                    simulator.cancel(agent, ask_id);
+                }
+                if (ask != invalid_price)
+                {
+                    ask_id = simulator.submit(agent, OrderType::GTC, Side::Sell, ask, config.quantity);
+                }
+                ask_price = ask;
+            }
+        }
+    }
+
+    auto taker(MarketSimulator& simulator, AgentId agent, TakerConfig config) -> AgentTask
+    {
+        while (true)
+        {
+            co_await simulator.sleep(agent, poisson_delay(simulator.random(agent), config.rate));
+
+            // The generator lives with the agent state, which may move when agents are added, so it is never cached.
+            auto&      random = simulator.random(agent);
+            const auto side   = random.bernoulli(0.5) ? Side::Buy : Side::Sell;
+            simulator.submit(agent, OrderType::None, side, invalid_price, draw_quantity(random, config.min_quantity, config.max_quantity));
+        }
+    }
+
+    auto noise_trader(MarketSimulator& simulator, AgentId agent, NoiseTraderConfig config) -> AgentTask
+    {
+        // Ring of the orders sent, the oldest is cancelled when it is full. Some are already filled by then.
+        const auto      capacity = std::max<usize>(config.max_live, 1);
+        Vector<OrderId> live(capacity);
+        usize           next = 0;
+        usize           sent = 0;
+
+        while (true)
+        {
+            co_await simulator.sleep(agent, poisson_delay(simulator.random(agent), config.rate));
+
+            auto&       random = simulator.random(agent);
+            const auto& data   = simulator.last_market_data(agent);
+            const auto  mid    = std::isnan(data.top.mid_price()) ? static_cast<float64>(config.initial_mid) : data.top.mid_price();
+
+            const auto side     = random.bernoulli(0.5) ? Side::Buy : Side::Sell;
+            const auto distance = static_cast<int64>(random.geometric(config.distance_decay, config.max_distance)) + 1;
+            const auto center   = static_cast<int64>(std::llround(mid));
+            const auto price    = static_cast<Price>(std::max<int64>(side == Side::Buy ? center - distance : center + distance, 1));
+
+            if (sent >= capacity)
+            {
+                simulator.cancel(agent, live[next]);
+            }
+            live[next] = simulator.submit(agent, OrderType::GTC, side, price, draw_quantity(random, config.min_quantity, config.max_quantity));
+            next       = (next + 1) % capacity;
+            ++sent;
+        }
+    }
+}
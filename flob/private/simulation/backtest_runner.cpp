@@ -0,0 +1,46 @@
+#include "simulation/backtest_runner.hpp"
+
+namespace flob
+{
+    auto run_backtest(const BacktestJob& job) -> BacktestResult
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        auto config         = job.book;
+        config.manual_clock = true;
+
+        OrderBook         book(config);
+        WorkloadGenerator generator(job.workload);
+
+        BacktestResult result(job.commands, 0, 0, invalid_price, 0, std::chrono::nanoseconds::zero());
+        const auto     count = [&result](const Trades& trades) {
+            result.trades += trades.size();
+            for (const auto& trade : trades)
+            {
+                result.volume += trade.quantity;
+            }
+        };
+
+        for (usize i = 0; i < job.commands; ++i)
+        {
+            const auto command = generator.next();
+            count(book.advance_time(config.start_time + std::chrono::nanoseconds(command.timestamp)));
+            count(book.apply(command));
+        }
+
+        result.last_price     = book.last_price();
+        result.resting_orders = book.size();
+        result.elapsed        = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return result;
+    }
+
+    BacktestRunner::BacktestRunner(usize workers)
+        : _pool(workers)
+        , _stats(std::chrono::nanoseconds::zero(), std::chrono::nanoseconds::zero(), 0, 0, _pool.size())
+    {}
+
+    auto BacktestRunner::run(const Vector<BacktestJob>& jobs) -> Vector<BacktestResult>
+    {
+        return run(jobs, run_backtest);
+    }
+}
@@ -0,0 +1,211 @@
+#include "simulation/market_simulator.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace flob
+{
+    namespace
+    {
+        // Order ids carry the agent in their upper bits, so fills are routed without a lookup.
+        constexpr uint32 agent_shift = 40;
+
+        constexpr auto make_order_id(AgentId agent, uint64 sequence) noexcept -> OrderId
+        {
+            return OrderId((static_cast<uint64>(agent) + 1) << agent_shift | sequence);
+        }
+
+        constexpr auto owner_of(OrderId order_id) noexcept -> uint64
+        {
+            return (static_cast<uint64>(order_id) >> agent_shift) - 1;
+        }
+    }
+
+    MarketSimulator::MarketSimulator(const SimulatorConfig& config)
+        : _book([&config] {
+            auto book         = config.book;
+            book.manual_clock = true;
+            return book;
+        }())
+        , _start(config.book.start_time)
+        , _seed(config.seed)
+        , _stats(0, 0, 0, 0)
+    {}
+
+    auto MarketSimulator::run(std::chrono::nanoseconds duration) -> void
+    {
+        const auto end = _now + static_cast<uint64>(duration.count());
+        while (!_events.empty() && _events.front().time <= end)
+        {
+            std::pop_heap(_events.begin(), _events.end(), std::greater<>());
+            const auto event = _events.back();
+            _events.pop_back();
+
+            _now = event.time;
+            ++_stats.events;
+            process(event);
+        }
+        _now = std::max(_now, end);
+    }
+
+    auto MarketSimulator::submit(AgentId agent, OrderType type, Side side, Price price, Quantity quantity) -> OrderId
+    {
+        const auto order_id = make_order_id(agent, ++_agents[agent].orders);
+
+        OrderCommand command(_now, order_id, price, quantity, CommandType::Add, type, side);
+        command.account = agent;
+        send(agent, command);
+        return order_id;
+    }
+
+    auto MarketSimulator::cancel(AgentId agent, OrderId order_id) -> void
+    {
+        send(agent, OrderCommand(_now, order_id, 0, 0, CommandType::Cancel, OrderType::GTC, Side::Buy));
+    }
+
+    auto MarketSimulator::modify(AgentId agent, OrderId order_id, Price price, Quantity quantity) -> void
+    {
+        send(agent, OrderCommand(_now, order_id, price, quantity, CommandType::Modify, OrderType::GTC, Side::Buy));
+    }
+
+    auto MarketSimulator::register_agent(const AgentLatency& latency, AgentTask task) -> AgentId
+    {
+        const auto agent = static_cast<AgentId>(_agents.size());
+
+        Agent state;
+        state.latency = latency;
+        state.task    = std::move(task);
+        state.random  = Random(_seed + agent);
+        _agents.push_back(std::move(state));
+
+        // Agents start in the order they were added.
+        schedule(std::chrono::nanoseconds::zero(), EventType::Resume, agent, 0);
+        return agent;
+    }
+
+    auto MarketSimulator::schedule(std::chrono::nanoseconds delay, EventType type, AgentId agent, uint32 value) -> void
+    {
+        _events.push_back(Event(_now + static_cast<uint64>(delay.count()), _sequence++, agent, value, type));
+        std::push_heap(_events.begin(), _events.end(), std::greater<>());
+    }
+
+    auto MarketSimulator::process(const Event& event) -> void
+    {
+        auto& agent = _agents[event.agent];
+        switch (event.type)
+        {
+            case EventType::Resume:
+            {
+                const auto handle = agent.task.handle();
+                if (!handle.done())
+                {
+                    handle.resume();
+                }
+                break;
+            }
+            case EventType::OrderEntry:
+            {
+                // Copied out first, the slot may be reused by the agents resumed in turn.
+                const auto command = _commands[event.value];
+                _free_commands.push_back(event.value);
+                execute(command);
+                break;
+            }
+            case EventType::Update:
+            {
+                auto& update = _updates[event.value];
+                agent.last   = update.data;
+                agent.unread = true;
+                if (--update.pending == 0)
+                {
+                    _free_updates.push_back(event.value);
+                }
+
+                if (agent.waiting)
+                {
+                    agent.waiting = false;
+                    agent.task.handle().resume();
+                }
+                break;
+            }
+            case EventType::BuyFill:  agent.position += event.value; break;
+            case EventType::SellFill: agent.position -= event.value; break;
+        }
+    }
+
+    auto MarketSimulator::send(AgentId agent, const OrderCommand& command) -> void
+    {
+        uint32 slot;
+        if (!_free_commands.empty())
+        {
+            slot = _free_commands.back();
+            _free_commands.pop_back();
+            _commands[slot] = command;
+        }
+        else
+        {
+            slot = static_cast<uint32>(_commands.size());
+            _commands.push_back(command);
+        }
+        schedule(_agents[agent].latency.order_entry, EventType::OrderEntry, agent, slot);
+    }
+
+    auto MarketSimulator::execute(const OrderCommand& command) -> void
+    {
+        ++_stats.orders;
+
+        // Expiries and batch auctions come due on the simulated clock first.
+        Trades trades;
+        _book.advance_time(now(), trades);
+        _book.apply(command, trades);
+        publish(trades);
+    }
+
+    auto MarketSimulator::publish(const Trades& trades) -> void
+    {
+        Quantity volume = 0;
+        for (const auto& trade : trades)
+        {
+            volume += trade.quantity;
+
+            const auto buyer  = owner_of(trade.bid_id);
+            const auto seller = owner_of(trade.ask_id);
+            if (buyer < _agents.size())
+            {
+                schedule(_agents[buyer].latency.market_data, EventType::BuyFill, static_cast<AgentId>(buyer), trade.quantity);
+            }
+            if (seller < _agents.size())
+            {
+                schedule(_agents[seller].latency.market_data, EventType::SellFill, static_cast<AgentId>(seller), trade.quantity);
+            }
+        }
+        _stats.trades += trades.size();
+        _stats.volume += volume;
+
+        const auto top = _book.top();
+        if (_agents.empty() || (top == _top && volume == 0))
+        {
+            // Nothing visible changed, e.g. a resting order joined a level behind the best one.
+            return;
+        }
+        _top = top;
+
+        uint32 slot;
+        if (!_free_updates.empty())
+        {
+            slot = _free_updates.back();
+            _free_updates.pop_back();
+        }
+        else
+        {
+            slot = static_cast<uint32>(_updates.size());
+            _updates.push_back({});
+        }
+        _updates[slot] = Update(MarketData(now(), top, _book.last_price(), volume), _agents.size());
+
+        for (AgentId agent = 0; agent < _agents.size(); ++agent)
+        {
+            schedule(_agents[agent].latency.market_data, EventType::Update, agent, slot);
+        }
+    }
+}
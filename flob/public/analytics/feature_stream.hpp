@@ -0,0 +1,214 @@
+#pragma once
+
+#include "core_types.hpp"
+#include "memory/mapped_file.hpp"
+#include "order_book/order.hpp"
+#include "order_book/types.hpp"
+
+#include <chrono>
+#include <limits>
+#include <string>
+
+namespace flob
+{
+    enum class FeatureSampling : uint8
+    {
+        Event,   // One row per change of the top of the book
+        Bucket,  // One row per time bucket with activity, holding the state at its end
+    };
+
+    struct FeatureConfig
+    {
+        FeatureSampling          sampling = FeatureSampling::Event;
+        std::chrono::nanoseconds bucket   = std::chrono::seconds(1);
+        usize                    capacity = usize(1) << 20;  // Rows kept, older rows are overwritten
+        std::string              path;                       // Backing file, anonymous memory when empty
+    };
+
+    struct TopOfBook
+    {
+        Price    bid_price    = invalid_price;
+        Quantity bid_quantity = 0;
+        Price    ask_price    = invalid_price;
+        Quantity ask_quantity = 0;
+
+        // NaN when either side is empty.
+        [[nodiscard]] constexpr auto spread() const noexcept -> float64;
+        [[nodiscard]] constexpr auto mid_price() const noexcept -> float64;
+        [[nodiscard]] constexpr auto micro_price() const noexcept -> float64;
+
+        // (bid - ask) / (bid + ask) over the displayed quantities, 0 when both are empty.
+        [[nodiscard]] constexpr auto imbalance() const noexcept -> float64;
+
+        auto operator==(const TopOfBook&) const -> bool = default;
+    };
+
+    enum class FeatureColumn : uint8
+    {
+        Time,  // int64 nanoseconds since the epoch, every other column is float64
+        BidPrice,
+        BidQuantity,
+        AskPrice,
+        AskQuantity,
+        Spread,
+        MidPrice,
+        MicroPrice,
+        Imbalance,
+        OrderFlow,  // Order flow imbalance of the event, or summed over the bucket
+        Count,
+    };
+
+    struct FeatureRow
+    {
+        TimePoint time;
+        TopOfBook top;
+        int64     order_flow;
+    };
+
+    // Fixed header at the start of the buffer. The columns follow it one after the other, `capacity` values each, so a
+    // reader maps the file and takes column c at offset sizeof(FeatureHeader) + c * capacity * 8, e.g. with
+    // numpy.memmap. Row i of the stream is stored in slot i % capacity.
+    struct FeatureHeader
+    {
+        char   magic[8];      // "FLOBFEAT"
+        uint32 version;
+        uint32 column_count;
+        uint64 capacity;
+        uint64 count;         // Rows written since the start, stored after the row itself
+        uint64 reserved[4];
+    };
+
+    static_assert(sizeof(FeatureHeader) == 64, "Readers rely on a 64 byte header");
+
+    // Microstructure features of the top of the book, sampled into a preallocated columnar buffer. The book reports its
+    // top after every event, updates are O(1) and never allocate: the spread, mid, microprice and imbalance follow from
+    // the top itself and the order flow imbalance of Cont, Kukanov and Stoikov from the previous one.
+    class FeatureStream
+    {
+    public:
+        static constexpr uint32 version = 1;
+
+    public:
+        explicit FeatureStream(const FeatureConfig& config = {});
+
+    public:
+        [[nodiscard]] constexpr auto top() const noexcept -> const TopOfBook&;
+
+        // Order flow imbalance accumulated since the start.
+        [[nodiscard]] constexpr auto order_flow() const noexcept -> int64;
+
+        auto on_book(TimePoint time, const TopOfBook& top) -> void;
+
+        // Writes the pending bucket, e.g. at the end of a run.
+        auto flush() -> void;
+
+        //--------------------------------------------------------------------------------------------------------------
+        // Sampled rows
+        //--------------------------------------------------------------------------------------------------------------
+
+        [[nodiscard]] constexpr auto capacity() const noexcept -> usize;
+        [[nodiscard]] constexpr auto count() const noexcept -> uint64;
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+
+        // Row `index` of the stream, only the last size() rows are still held.
+        [[nodiscard]] auto row(uint64 index) const noexcept -> FeatureRow;
+
+        [[nodiscard]] constexpr auto buffer() const noexcept -> const MappedFile&;
+
+    private:
+        auto append(TimePoint time, int64 order_flow) -> void;
+
+        template <typename T>
+        [[nodiscard]] auto column(FeatureColumn column) const noexcept -> T*;
+
+    private:
+        FeatureConfig  _config;
+        MappedFile     _buffer;
+        FeatureHeader* _header  = nullptr;
+        std::byte*     _columns = nullptr;  // Into _buffer, past the header
+        uint64         _count   = 0;
+
+        TopOfBook _top;
+        int64     _order_flow        = 0;
+        int64     _bucket_order_flow = 0;
+        int64     _bucket            = -1;  // Index of the current bucket since the epoch
+        bool      _bucket_pending    = false;
+    };
+
+    //==============================================================================================
+    // struct : TopOfBook
+    //==============================================================================================
+
+    constexpr auto TopOfBook::spread() const noexcept -> float64
+    {
+        if (bid_price == invalid_price || ask_price == invalid_price)
+        {
+            return std::numeric_limits<float64>::quiet_NaN();
+        }
+        return static_cast<float64>(ask_price) - bid_price;
+    }
+
+    constexpr auto TopOfBook::mid_price() const noexcept -> float64
+    {
+        if (bid_price == invalid_price || ask_price == invalid_price)
+        {
+            return std::numeric_limits<float64>::quiet_NaN();
+        }
+        return (static_cast<float64>(bid_price) + ask_price) / 2.0;
+    }
+
+    constexpr auto TopOfBook::micro_price() const noexcept -> float64
+    {
+        if (bid_price == invalid_price || ask_price == invalid_price)
+        {
+            return std::numeric_limits<float64>::quiet_NaN();
+        }
+
+        const auto depth = static_cast<float64>(bid_quantity) + ask_quantity;
+        if (depth == 0.0)
+        {
+            return mid_price();
+        }
+        return (static_cast<float64>(bid_price) * ask_quantity + static_cast<float64>(ask_price) * bid_quantity) / depth;
+    }
+
+    constexpr auto TopOfBook::imbalance() const noexcept -> float64
+    {
+        const auto depth = static_cast<float64>(bid_quantity) + ask_quantity;
+        return depth == 0.0 ? 0.0 : (static_cast<float64>(bid_quantity) - ask_quantity) / depth;
+    }
+
+    //==============================================================================================
+    // class : FeatureStream
+    //==============================================================================================
+
+    constexpr auto FeatureStream::top() const noexcept -> const TopOfBook&
+    {
+        return _top;
+    }
+
+    constexpr auto FeatureStream::order_flow() const noexcept -> int64
+    {
+        return _order_flow;
+    }
+
+    constexpr auto FeatureStream::capacity() const noexcept -> usize
+    {
+        return _buffer.empty() ? 0 : _config.capacity;
+    }
+
+    constexpr auto FeatureStream::count() const noexcept -> uint64
+    {
+        return _count;
+    }
+
+    constexpr auto FeatureStream::size() const noexcept -> usize
+    {
+        return _count < capacity() ? _count : capacity();
+    }
+
+    constexpr auto FeatureStream::buffer() const noexcept -> const MappedFile&
+    {
+        return _buffer;
+    }
+}
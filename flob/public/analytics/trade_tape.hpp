@@ -0,0 +1,128 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "memory/mapped_file.hpp"
+#include "order_book/order.hpp"
+#include "order_book/trade.hpp"
+#include "order_book/types.hpp"
+
+#include <string_view>
+
+namespace flob
+{
+    enum class Aggressor : uint8
+    {
+        Buy,
+        Sell,
+        None,  // Auction uncross, both sides were resting
+    };
+
+    struct TradeTapeConfig
+    {
+        usize block_rows      = usize(1) << 16;  // Trades per block, rounded up to a multiple of 8
+        usize reserved_blocks = 1;               // Blocks allocated up front, more are added as the tape grows
+    };
+
+    enum class TapeColumn : uint8
+    {
+        Sequence,   // uint64, position of the trade on the tape
+        Time,       // int64 nanoseconds since the epoch, book clock
+        BidId,      // uint64
+        AskId,      // uint64
+        Price,      // uint32 execution price
+        Quantity,   // uint32
+        Aggressor,  // uint8
+        Count,
+    };
+
+    struct TapeRecord
+    {
+        uint64    sequence;
+        TimePoint time;
+        OrderId   bid_id;
+        OrderId   ask_id;
+        Price     price;
+        Quantity  quantity;
+        Aggressor aggressor;
+    };
+
+    // Fixed header at the start of an exported tape. Blocks of `block_rows` trades follow it, each holding the columns
+    // one after the other in TapeColumn order with `block_rows` values each, so column c of block b starts at
+    // sizeof(TapeHeader) + b * block_size + block_rows * (sum of the widths of the columns before c). Only the first
+    // `count` rows are meaningful, the rest of the last block is zero.
+    struct TapeHeader
+    {
+        char   magic[8];  // "FLOBTAPE"
+        uint32 version;
+        uint32 column_count;
+        uint64 block_rows;
+        uint64 block_size;  // Bytes per block
+        uint64 count;
+        uint64 reserved[3];
+    };
+
+    static_assert(sizeof(TapeHeader) == 64, "Readers rely on a 64 byte header");
+
+    // Append-only columnar record of the trades of a book. Trades go into fixed size blocks that are allocated whole,
+    // so appending is a handful of stores and only allocates once per block. Unlike the Trade returned by the book, a
+    // record holds the execution price, the aggressor side, the time and the sequence number of the trade.
+    class TradeTape
+    {
+    public:
+        static constexpr uint32 version = 1;
+
+    public:
+        explicit TradeTape(const TradeTapeConfig& config = {});
+
+    public:
+        [[nodiscard]] constexpr auto count() const noexcept -> uint64;
+        [[nodiscard]] constexpr auto block_rows() const noexcept -> usize;
+        [[nodiscard]] constexpr auto block_count() const noexcept -> usize;
+
+        // Bytes per block, all columns included.
+        [[nodiscard]] static constexpr auto block_size(usize rows) noexcept -> usize;
+
+        auto append(const Trade& trade, Price price, Aggressor aggressor, TimePoint time) -> void;
+
+        [[nodiscard]] auto record(uint64 sequence) const noexcept -> TapeRecord;
+
+        // Writes the header and the blocks to `path`, replacing the file. The result maps as is, nothing needs parsing.
+        auto write(std::string_view path) const -> bool;
+
+    private:
+        auto add_block() -> bool;
+
+        template <typename T>
+        [[nodiscard]] auto column(usize block, TapeColumn column) const noexcept -> T*;
+
+    private:
+        usize              _block_rows;
+        Vector<MappedFile> _blocks;
+        uint64             _count = 0;
+    };
+
+    //==============================================================================================
+    // class : TradeTape
+    //==============================================================================================
+
+    constexpr auto TradeTape::count() const noexcept -> uint64
+    {
+        return _count;
+    }
+
+    constexpr auto TradeTape::block_rows() const noexcept -> usize
+    {
+        return _block_rows;
+    }
+
+    constexpr auto TradeTape::block_count() const noexcept -> usize
+    {
+        return _blocks.size();
+    }
+
+    constexpr auto TradeTape::block_size(usize rows) noexcept -> usize
+    {
+        return rows * (4 * sizeof(uint64) + sizeof(Price) + sizeof(Quantity) + sizeof(Aggressor));
+    }
+}
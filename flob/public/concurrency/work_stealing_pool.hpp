@@ -0,0 +1,103 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace flob
+{
+    struct PoolStats
+    {
+        std::chrono::nanoseconds wall;     // From the start of parallel_for() to the end of its last task
+        std::chrono::nanoseconds busy;     // Time spent inside tasks, summed over the workers
+        uint64                   tasks;
+        uint64                   steals;
+        usize                    workers;
+
+        // Share of the worker time not spent in tasks: waking up, stealing and idling behind the last task.
+        [[nodiscard]] constexpr auto overhead() const noexcept -> float64;
+    };
+
+    // Fixed set of workers running index ranges. Each worker starts with an equal slice of the range and takes indices
+    // from its front, an idle worker steals the back half of the first busy slice it finds. Slices are single atomic
+    // words updated by compare-and-swap, so taking a task never locks and uneven tasks still balance out.
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool(usize workers = std::thread::hardware_concurrency());
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool&)                    = delete;
+        auto operator=(const WorkStealingPool&) -> WorkStealingPool& = delete;
+
+    public:
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+
+        // Calls body(worker, index) for every index below `count` and blocks until all calls returned. The calling
+        // thread does not take part, and bodies must not call back into the pool.
+        template <typename Body>
+        auto parallel_for(usize count, Body&& body) -> PoolStats;
+
+    private:
+        using Invoke = void (*)(void* body, usize worker, usize index);
+
+        struct alignas(64) Worker
+        {
+            std::atomic<uint64> range;  // Begin in the high half, end in the low half
+            uint64              tasks;
+            uint64              steals;
+            int64               busy;   // Nanoseconds
+        };
+
+        auto run(usize count, Invoke invoke, void* body) -> PoolStats;
+        auto work(usize worker) -> void;
+        auto drain(usize worker) -> void;
+        auto pop(usize worker, usize& index) noexcept -> bool;
+        auto steal(usize thief, usize& index) noexcept -> bool;
+
+    private:
+        usize                     _size;
+        std::unique_ptr<Worker[]> _workers;
+        Vector<std::thread>       _threads;
+
+        Invoke _invoke = nullptr;
+        void*  _body   = nullptr;
+
+        std::atomic<uint64> _generation = 0;  // Bumped to wake the workers up
+        std::atomic<usize>  _running    = 0;  // Workers still draining the current range
+        std::atomic<bool>   _stop       = false;
+    };
+
+    //==============================================================================================
+    // struct : PoolStats
+    //==============================================================================================
+
+    constexpr auto PoolStats::overhead() const noexcept -> float64
+    {
+        const auto available = static_cast<float64>(wall.count()) * workers;
+        return available == 0.0 ? 0.0 : 1.0 - static_cast<float64>(busy.count()) / available;
+    }
+
+    //==============================================================================================
+    // class : WorkStealingPool
+    //==============================================================================================
+
+    constexpr auto WorkStealingPool::size() const noexcept -> usize
+    {
+        return _size;
+    }
+
+    template <typename Body>
+    auto WorkStealingPool::parallel_for(usize count, Body&& body) -> PoolStats
+    {
+        using Function = std::remove_reference_t<Body>;
+
+        const auto invoke = [](void* function, usize worker, usize index) { (*static_cast<Function*>(function))(worker, index); };
+        return run(count, invoke, const_cast<void*>(static_cast<const void*>(std::addressof(body))));
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "debug/ensure.hpp"
+
+#include <bit>
+
+namespace flob
+{
+    // Binary indexed tree over a fixed number of elements, all starting at zero. Point updates, prefix sums and
+    // searches on the prefix sums are O(log n) and never allocate.
+    template <typename T>
+    class FenwickTree
+    {
+    public:
+        FenwickTree() noexcept = default;
+        explicit FenwickTree(usize size) noexcept;
+
+    public:
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+
+        constexpr auto add(usize index, T delta) noexcept -> void;
+
+        // Sum of the first `count` elements.
+        [[nodiscard]] constexpr auto prefix(usize count) const noexcept -> T;
+
+        // Index of the element where the prefix sum reaches `value`, or size() when the total is below it. Only valid
+        // when no element is negative.
+        [[nodiscard]] constexpr auto lower_bound(T value) const noexcept -> usize;
+
+    private:
+        Vector<T> _tree;  // 1-based, the first slot is unused
+    };
+
+    //==============================================================================================
+    // class : FenwickTree
+    //==============================================================================================
+
+    template <typename T>
+    FenwickTree<T>::FenwickTree(usize size) noexcept
+        : _tree(size + 1, T())
+    {}
+
+    template <typename T>
+    constexpr auto FenwickTree<T>::size() const noexcept -> usize
+    {
+        return _tree.empty() ? 0 : _tree.size() - 1;
+    }
+
+    template <typename T>
+    constexpr auto FenwickTree<T>::add(usize index, T delta) noexcept -> void
+    {
+        ensure(index < size(), "Index out of range");
+        for (auto i = index + 1; i < _tree.size(); i += i & (~i + 1))
+        {
+            _tree[i] += delta;
+        }
+    }
+
+    template <typename T>
+    constexpr auto FenwickTree<T>::prefix(usize count) const noexcept -> T
+    {
+        ensure(count <= size(), "Count out of range");
+
+        T sum = T();
+        for (auto i = count; i > 0; i &= i - 1)
+        {
+            sum += _tree[i];
+        }
+        return sum;
+    }
+
+    template <typename T>
+    constexpr auto FenwickTree<T>::lower_bound(T value) const noexcept -> usize
+    {
+        // Descends the implicit tree from the largest power of two, skipping every subtree whose sum stays below.
+        usize position = 0;
+        for (auto step = std::bit_floor(size()); step > 0; step >>= 1)
+        {
+            if (position + step <= size() && _tree[position + step] < value)
+            {
+                position += step;
+                value -= _tree[position];
+            }
+        }
+        return position;
+    }
+}
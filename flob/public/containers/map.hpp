@@ -1,10 +1,11 @@
 #pragma once
 
 #include <map>
+#include <memory>
 
 namespace flob
 {
     // TODO: Implement own Map.
-    template <typename K, typename T, typename Compare = std::less<K>>
-    using Map = std::map<K, T, Compare>;
+    template <typename K, typename T, typename Compare = std::less<K>, typename Allocator = std::allocator<std::pair<const K, T>>>
+    using Map = std::map<K, T, Compare, Allocator>;
 }
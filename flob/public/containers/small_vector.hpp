@@ -0,0 +1,535 @@
+#pragma once
+
+#include "core_types.hpp"
+#include "memory/trivially_relocatable.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+
+namespace flob
+{
+    // Vector with inline storage for the first N elements. It only touches the heap once it grows past N, which makes it
+    // suitable for short-lived results (trades of a single order, top of book levels) returned by value.
+    template <typename T, usize N>
+    class SmallVector
+    {
+        static_assert(N > 0, "SmallVector inline capacity must be greater than 0");
+
+    public:
+        //--------------------------------------------------------------------------------------------------------------
+        // Constructors
+        //--------------------------------------------------------------------------------------------------------------
+
+        constexpr SmallVector() noexcept;
+        constexpr explicit SmallVector(usize count) noexcept;
+        constexpr SmallVector(usize count, const T& value) noexcept;
+        constexpr SmallVector(std::initializer_list<T> init) noexcept;
+
+        constexpr SmallVector(const SmallVector& other) noexcept;
+        constexpr SmallVector(SmallVector&& other) noexcept;
+
+        constexpr ~SmallVector() noexcept;
+
+    public:
+        constexpr auto operator=(const SmallVector& other) noexcept -> SmallVector&;
+        constexpr auto operator=(SmallVector&& other) noexcept -> SmallVector&;
+
+    public:
+        //--------------------------------------------------------------------------------------------------------------
+        // Element access
+        //--------------------------------------------------------------------------------------------------------------
+
+        constexpr auto               at(usize index) -> T&;
+        [[nodiscard]] constexpr auto at(usize index) const -> const T&;
+
+        constexpr auto operator[](usize index) noexcept -> T&;
+        constexpr auto operator[](usize index) const noexcept -> const T&;
+
+        constexpr auto               front() noexcept -> T&;
+        [[nodiscard]] constexpr auto front() const noexcept -> const T&;
+
+        constexpr auto               back() noexcept -> T&;
+        [[nodiscard]] constexpr auto back() const noexcept -> const T&;
+
+        constexpr auto               data() noexcept -> T*;
+        [[nodiscard]] constexpr auto data() const noexcept -> const T*;
+
+        //--------------------------------------------------------------------------------------------------------------
+        // Iterators
+        //--------------------------------------------------------------------------------------------------------------
+
+        constexpr auto               begin() noexcept -> T*;
+        [[nodiscard]] constexpr auto begin() const noexcept -> const T*;
+        [[nodiscard]] constexpr auto cbegin() const noexcept -> const T*;
+
+        constexpr auto               end() noexcept -> T*;
+        [[nodiscard]] constexpr auto end() const noexcept -> const T*;
+        [[nodiscard]] constexpr auto cend() const noexcept -> const T*;
+
+        //--------------------------------------------------------------------------------------------------------------
+        // Capacity
+        //--------------------------------------------------------------------------------------------------------------
+
+        [[nodiscard]] constexpr auto empty() const noexcept -> bool;
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+        [[nodiscard]] constexpr auto capacity() const noexcept -> usize;
+        [[nodiscard]] constexpr auto is_inline() const noexcept -> bool;
+
+        constexpr auto reserve(usize size) noexcept -> void;
+
+        //--------------------------------------------------------------------------------------------------------------
+        // Modifiers
+        //--------------------------------------------------------------------------------------------------------------
+
+        constexpr auto clear() noexcept -> void;
+
+        constexpr auto erase(const T* first, const T* last) noexcept -> T*;
+        constexpr auto erase(const T* pos) noexcept -> T*;
+
+        constexpr auto push_back(const T& value) noexcept -> void;
+        constexpr auto push_back(T&& value) noexcept -> void;
+
+        template <typename... Args>
+        constexpr auto emplace_back(Args&&... args) noexcept -> T&;
+
+        constexpr auto pop_back() noexcept -> void;
+
+        constexpr auto resize(usize size) noexcept -> void;
+        constexpr auto resize(usize size, const T& value) noexcept -> void;
+
+    private:
+        static constexpr auto growth_factor = 1.5f;
+
+        auto inline_data() noexcept -> T*;
+        auto release_heap() noexcept -> void;
+        auto steal(SmallVector& other) noexcept -> void;
+
+        auto realloc(usize capacity) -> void;
+
+    private:
+        T*    _data;
+        usize _size;
+        usize _capacity;
+
+        alignas(T) std::byte _inline[N * sizeof(T)];
+    };
+
+    //==============================================================================================
+    // class : SmallVector
+    //==============================================================================================
+
+    template <typename T, usize N>
+    constexpr SmallVector<T, N>::SmallVector() noexcept
+        : _data(inline_data())
+        , _size(0)
+        , _capacity(N)
+    {}
+
+    template <typename T, usize N>
+    constexpr SmallVector<T, N>::SmallVector(usize count) noexcept
+        : SmallVector(count, T())
+    {}
+
+    template <typename T, usize N>
+    constexpr SmallVector<T, N>::SmallVector(usize count, const T& value) noexcept
+        : SmallVector()
+    {
+        reserve(count);
+        for (usize i = 0; i < count; ++i)
+        {
+            new (&_data[i]) T(value);
+        }
+        _size = count;
+    }
+
+    template <typename T, usize N>
+    constexpr SmallVector<T, N>::SmallVector(std::initializer_list<T> init) noexcept
+        : SmallVector()
+    {
+        reserve(init.size());
+        for (const T& elem : init)
+        {
+            new (&_data[_size]) T(elem);
+            ++_size;
+        }
+    }
+
+    template <typename T, usize N>
+    constexpr SmallVector<T, N>::SmallVector(const SmallVector& other) noexcept
+        : SmallVector()
+    {
+        reserve(other._size);
+        for (usize i = 0; i < other._size; ++i)
+        {
+            new (&_data[i]) T(other._data[i]);
+        }
+        _size = other._size;
+    }
+
+    template <typename T, usize N>
+    constexpr SmallVector<T, N>::SmallVector(SmallVector&& other) noexcept
+        : SmallVector()
+    {
+        steal(other);
+    }
+
+    template <typename T, usize N>
+    constexpr SmallVector<T, N>::~SmallVector() noexcept
+    {
+        clear();
+        release_heap();
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::operator=(const SmallVector& other) noexcept -> SmallVector&
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other._size);
+
+            for (usize i = 0; i < other._size; ++i)
+            {
+                new (&_data[i]) T(other._data[i]);
+            }
+            _size = other._size;
+        }
+        return *this;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::operator=(SmallVector&& other) noexcept -> SmallVector&
+    {
+        if (this != &other)
+        {
+            clear();
+            release_heap();
+            steal(other);
+        }
+        return *this;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::at(usize index) -> T&
+    {
+        if (index >= _size)
+        {
+            throw std::out_of_range("SmallVector::at() index out of range");
+        }
+        return _data[index];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::at(usize index) const -> const T&
+    {
+        if (index >= _size)
+        {
+            throw std::out_of_range("SmallVector::at() index out of range");
+        }
+        return _data[index];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::operator[](usize index) noexcept -> T&
+    {
+        return _data[index];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::operator[](usize index) const noexcept -> const T&
+    {
+        return _data[index];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::front() noexcept -> T&
+    {
+        return _data[0];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::front() const noexcept -> const T&
+    {
+        return _data[0];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::back() noexcept -> T&
+    {
+        return _data[_size - 1];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::back() const noexcept -> const T&
+    {
+        return _data[_size - 1];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::data() noexcept -> T*
+    {
+        return _data;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::data() const noexcept -> const T*
+    {
+        return _data;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::begin() noexcept -> T*
+    {
+        return _data;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::begin() const noexcept -> const T*
+    {
+        return _data;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::cbegin() const noexcept -> const T*
+    {
+        return _data;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::end() noexcept -> T*
+    {
+        return _data + _size;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::end() const noexcept -> const T*
+    {
+        return _data + _size;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::cend() const noexcept -> const T*
+    {
+        return _data + _size;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::empty() const noexcept -> bool
+    {
+        return _size == 0;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::size() const noexcept -> usize
+    {
+        return _size;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::capacity() const noexcept -> usize
+    {
+        return _capacity;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::is_inline() const noexcept -> bool
+    {
+        return _data == reinterpret_cast<const T*>(_inline);
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::reserve(usize size) noexcept -> void
+    {
+        if (size > _capacity)
+        {
+            realloc(size);
+        }
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::clear() noexcept -> void
+    {
+        for (usize i = 0; i < _size; ++i)
+        {
+            _data[i].~T();
+        }
+
+        _size = 0;
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::erase(const T* first, const T* last) noexcept -> T*
+    {
+        auto write  = begin() + (first - _data);
+        auto read   = begin() + (last - _data);
+        auto it_end = end();
+
+        for (; read != it_end; ++read, ++write)
+        {
+            *write = std::move(*read);
+        }
+
+        auto new_size = write - begin();
+        for (auto destroy_it = begin() + new_size; destroy_it != it_end; ++destroy_it)
+        {
+            destroy_it->~T();
+        }
+
+        _size = new_size;
+        return begin() + (first - _data);
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::erase(const T* pos) noexcept -> T*
+    {
+        auto idx = pos - _data;
+        return erase(begin() + idx, begin() + idx + 1);
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::push_back(const T& value) noexcept -> void
+    {
+        emplace_back(value);
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::push_back(T&& value) noexcept -> void
+    {
+        emplace_back(std::move(value));
+    }
+
+    template <typename T, usize N>
+    template <typename... Args>
+    constexpr auto SmallVector<T, N>::emplace_back(Args&&... args) noexcept -> T&
+    {
+        if (_size >= _capacity)
+        {
+            realloc(std::max(static_cast<usize>(_capacity * growth_factor), _capacity + 1));
+        }
+
+        new (&_data[_size]) T(std::forward<Args>(args)...);
+        return _data[_size++];
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::pop_back() noexcept -> void
+    {
+        if (_size > 0)
+        {
+            _data[--_size].~T();
+        }
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::resize(usize size) noexcept -> void
+    {
+        resize(size, T());
+    }
+
+    template <typename T, usize N>
+    constexpr auto SmallVector<T, N>::resize(usize size, const T& value) noexcept -> void
+    {
+        if (size < _size)
+        {
+            for (usize i = size; i < _size; ++i)
+            {
+                _data[i].~T();
+            }
+        }
+        else if (size > _size)
+        {
+            reserve(size);
+            for (usize i = _size; i < size; ++i)
+            {
+                new (&_data[i]) T(value);
+            }
+        }
+        _size = size;
+    }
+
+    template <typename T, usize N>
+    auto SmallVector<T, N>::inline_data() noexcept -> T*
+    {
+        return reinterpret_cast<T*>(_inline);
+    }
+
+    template <typename T, usize N>
+    auto SmallVector<T, N>::release_heap() noexcept -> void
+    {
+        if (!is_inline())
+        {
+            ::operator delete(_data);
+        }
+        _data     = inline_data();
+        _capacity = N;
+    }
+
+    template <typename T, usize N>
+    auto SmallVector<T, N>::steal(SmallVector& other) noexcept -> void
+    {
+        // Expects `this` to be empty and inline.
+        if (other.is_inline())
+        {
+            relocate(other._data, other._size, _data);
+            _size = other._size;
+        }
+        else
+        {
+            _data     = other._data;
+            _size     = other._size;
+            _capacity = other._capacity;
+
+            other._data     = other.inline_data();
+            other._capacity = N;
+        }
+        other._size = 0;
+    }
+
+    template <typename T, usize N>
+    auto SmallVector<T, N>::realloc(usize capacity) -> void
+    {
+        // Inline storage is never shrunk into, growth only moves to a larger heap block.
+        if (capacity <= _capacity)
+        {
+            return;
+        }
+
+        T* new_data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        relocate(_data, _size, new_data);
+
+        if (!is_inline())
+        {
+            ::operator delete(_data);
+        }
+
+        _data     = new_data;
+        _capacity = capacity;
+    }
+}
+
+template <typename T, flob::usize N>
+struct std::formatter<flob::SmallVector<T, N>>
+{
+    constexpr auto parse(std::format_parse_context& ctx) { return ctx.begin(); }
+
+    template <typename FormatContext>
+    auto format(const flob::SmallVector<T, N>& vector, FormatContext& ctx) const
+    {
+        auto out = ctx.out();
+        out      = std::format_to(ctx.out(), "[");
+        if (vector.size() > 0)
+        {
+            auto it = vector.begin();
+            out     = std::format_to(out, "{}", *it);
+            for (++it; it != vector.end(); ++it)
+            {
+                out = std::format_to(out, ", {}", *it);
+            }
+        }
+        return std::format_to(out, "]");
+    }
+};
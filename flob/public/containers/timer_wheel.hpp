@@ -0,0 +1,316 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "debug/ensure.hpp"
+#include "memory/pages.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace flob
+{
+    using TimerHandle = uint32;
+
+    constexpr auto invalid_timer = std::numeric_limits<TimerHandle>::max();
+
+    // Hierarchical timer wheel over integer ticks. Level l has 256 slots of 256^l ticks each, so four levels cover 2^32
+    // ticks ahead of the current one, later timers are parked in the last level and re-inserted when reached.
+    // Insert and cancel are O(1). Advancing only stops on slots that hold timers, found through per-level occupancy
+    // bitmaps, so its cost depends on the cascaded and expired timers rather than on how far the wheel moves.
+    template <typename T>
+    class TimerWheel
+    {
+    public:
+        explicit TimerWheel(uint64 current_tick = 0) noexcept;
+
+    public:
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+        [[nodiscard]] constexpr auto empty() const noexcept -> bool;
+        [[nodiscard]] constexpr auto current_tick() const noexcept -> uint64;
+
+        auto reserve(usize capacity, const PageConfig& pages = {}) -> void;
+
+        // Timers due at or before the current tick fire on the next advance.
+        auto insert(uint64 tick, const T& value) -> TimerHandle;
+        auto cancel(TimerHandle handle) noexcept -> void;
+
+        // Moves the wheel to `tick` and calls `expire(value)` for every timer that came due, in tick order.
+        template <typename Callback>
+        auto advance(uint64 tick, Callback&& expire) -> void;
+
+    private:
+        static constexpr uint32 slot_bits   = 8;
+        static constexpr uint32 slot_count  = 1 << slot_bits;
+        static constexpr uint64 slot_mask   = slot_count - 1;
+        static constexpr uint32 level_count = 4;
+
+        struct Node
+        {
+            T      value;
+            uint64 tick;
+            uint32 prev;
+            uint32 next;
+            uint32 slot;  // Index in _slots, or the next free node when unused
+        };
+
+        auto place(uint32 index, uint64 earliest) noexcept -> void;
+        auto unlink(uint32 index) noexcept -> void;
+        auto release(uint32 index) noexcept -> void;
+        auto cascade() noexcept -> void;
+
+        [[nodiscard]] auto next_occupied_slot(uint32 level, uint64 from) const noexcept -> uint64;
+        [[nodiscard]] auto next_event_tick() const noexcept -> uint64;
+
+    private:
+        Vector<Node> _nodes;
+        uint32       _free;
+        usize        _size;
+        uint64       _current;
+
+        uint32 _slots[level_count * slot_count];
+        uint64 _occupied[level_count][slot_count / 64];  // Non-empty slots of each level
+    };
+
+    //==============================================================================================
+    // class : TimerWheel
+    //==============================================================================================
+
+    template <typename T>
+    TimerWheel<T>::TimerWheel(uint64 current_tick) noexcept
+        : _free(invalid_timer)
+        , _size(0)
+        , _current(current_tick)
+        , _occupied()
+    {
+        std::fill(std::begin(_slots), std::end(_slots), invalid_timer);
+    }
+
+    template <typename T>
+    constexpr auto TimerWheel<T>::size() const noexcept -> usize
+    {
+        return _size;
+    }
+
+    template <typename T>
+    constexpr auto TimerWheel<T>::empty() const noexcept -> bool
+    {
+        return _size == 0;
+    }
+
+    template <typename T>
+    constexpr auto TimerWheel<T>::current_tick() const noexcept -> uint64
+    {
+        return _current;
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::reserve(usize capacity, const PageConfig& pages) -> void
+    {
+        _nodes.reserve(capacity);
+        prepare_pages(_nodes.data(), _nodes.capacity() * sizeof(Node), pages);
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::insert(uint64 tick, const T& value) -> TimerHandle
+    {
+        uint32 index;
+        if (_free != invalid_timer)
+        {
+            index         = _free;
+            _free         = _nodes[index].slot;
+            _nodes[index] = Node(value, tick, invalid_timer, invalid_timer, 0);
+        }
+        else
+        {
+            index = static_cast<uint32>(_nodes.size());
+            _nodes.emplace_back(value, tick, invalid_timer, invalid_timer, 0);
+        }
+
+        place(index, _current + 1);
+        ++_size;
+        return index;
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::cancel(TimerHandle handle) noexcept -> void
+    {
+        if (handle == invalid_timer)
+        {
+            return;
+        }
+
+        unlink(handle);
+        release(handle);
+        --_size;
+    }
+
+    template <typename T>
+    template <typename Callback>
+    auto TimerWheel<T>::advance(uint64 tick, Callback&& expire) -> void
+    {
+        while (_current < tick)
+        {
+            if (_size == 0)
+            {
+                _current = tick;
+                break;
+            }
+
+            _current = std::min(tick, next_event_tick());
+
+            if ((_current & slot_mask) == 0)
+            {
+                cascade();
+            }
+
+            const auto slot = static_cast<uint32>(_current & slot_mask);
+            while (_slots[slot] != invalid_timer)
+            {
+                const auto index = _slots[slot];
+                unlink(index);
+
+                if (_nodes[index].tick > _current)
+                {
+                    // Parked beyond the wheel span, not due yet.
+                    place(index, _current + 1);
+                    continue;
+                }
+
+                const auto value = _nodes[index].value;
+                release(index);
+                --_size;
+                expire(value);
+            }
+        }
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::place(uint32 index, uint64 earliest) noexcept -> void
+    {
+        auto& node = _nodes[index];
+
+        // Overdue timers go in the earliest slot still to be visited, timers too far ahead are clamped to the last
+        // reachable tick. The level only depends on the distance to the current tick, while the slot is given by the
+        // absolute tick, so each slot is visited exactly when its timers need to move down or fire.
+        const auto max_tick = _current + (uint64(1) << (slot_bits * level_count)) - 1;
+        const auto tick     = std::clamp(node.tick, earliest, max_tick);
+
+        const auto diff  = tick - _current;
+        const auto level = diff < slot_count ? 0 : static_cast<uint32>(std::bit_width(diff) - 1) / slot_bits;
+        const auto slot  = level * slot_count + static_cast<uint32>((tick >> (level * slot_bits)) & slot_mask);
+
+        node.slot = slot;
+        node.prev = invalid_timer;
+        node.next = _slots[slot];
+        if (node.next != invalid_timer)
+        {
+            _nodes[node.next].prev = index;
+        }
+        _slots[slot] = index;
+
+        const auto digit = slot % slot_count;
+        _occupied[level][digit / 64] |= uint64(1) << (digit % 64);
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::unlink(uint32 index) noexcept -> void
+    {
+        const auto& node = _nodes[index];
+        if (node.prev != invalid_timer)
+        {
+            _nodes[node.prev].next = node.next;
+        }
+        else
+        {
+            _slots[node.slot] = node.next;
+            if (node.next == invalid_timer)
+            {
+                const auto digit = node.slot % slot_count;
+                _occupied[node.slot / slot_count][digit / 64] &= ~(uint64(1) << (digit % 64));
+            }
+        }
+        if (node.next != invalid_timer)
+        {
+            _nodes[node.next].prev = node.prev;
+        }
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::release(uint32 index) noexcept -> void
+    {
+        _nodes[index].slot = _free;
+        _free              = index;
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::cascade() noexcept -> void
+    {
+        // The current tick starts a new rotation of one or more levels. Timers of the matching slots now fall within a
+        // lower level, higher levels are redistributed first since they can refill the slots of the lower ones.
+        uint32 top = 1;
+        while (top < level_count - 1 && ((_current >> (top * slot_bits)) & slot_mask) == 0)
+        {
+            ++top;
+        }
+
+        for (uint32 level = top; level > 0; --level)
+        {
+            const auto slot = level * slot_count + static_cast<uint32>((_current >> (level * slot_bits)) & slot_mask);
+
+            auto index   = _slots[slot];
+            _slots[slot] = invalid_timer;
+
+            const auto digit = slot % slot_count;
+            _occupied[level][digit / 64] &= ~(uint64(1) << (digit % 64));
+
+            while (index != invalid_timer)
+            {
+                const auto next = _nodes[index].next;
+                place(index, _current);
+                index = next;
+            }
+        }
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::next_occupied_slot(uint32 level, uint64 from) const noexcept -> uint64
+    {
+        for (auto slot = from; slot < slot_count; slot = (slot | 63) + 1)
+        {
+            const auto bits = _occupied[level][slot / 64] >> (slot % 64);
+            if (bits != 0)
+            {
+                return slot + std::countr_zero(bits);
+            }
+        }
+        return slot_count;
+    }
+
+    template <typename T>
+    auto TimerWheel<T>::next_event_tick() const noexcept -> uint64
+    {
+        // Earliest tick at which an occupied slot of any level is visited. Slots at or before the current one in their
+        // rotation are only visited in the next rotation. Empty slots are never visited, whatever cascades into them
+        // comes from an occupied slot of a higher level.
+        auto next = std::numeric_limits<uint64>::max();
+        for (uint32 level = 0; level < level_count; ++level)
+        {
+            const auto shift    = level * slot_bits;
+            const auto span     = uint64(1) << (shift + slot_bits);
+            const auto rotation = _current & ~(span - 1);
+            const auto digit    = (_current >> shift) & slot_mask;
+
+            if (const auto slot = next_occupied_slot(level, digit + 1); slot < slot_count)
+            {
+                next = std::min(next, rotation + (slot << shift));
+            }
+            else if (const auto wrapped = next_occupied_slot(level, 0); wrapped <= digit)
+            {
+                next = std::min(next, rotation + span + (wrapped << shift));
+            }
+        }
+        return next;
+    }
+}
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "core_types.hpp"
+#include "memory/trivially_relocatable.hpp"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdlib>
 #include <format>
 #include <initializer_list>
 #include <new>
@@ -95,7 +98,16 @@ namespace flob
         constexpr auto resize(usize size, const T& value) noexcept -> void;
 
     private:
-        static constexpr auto growth_factor = 1.5f;
+        static constexpr auto  growth_factor = 1.5f;
+        static constexpr usize min_capacity  = std::max<usize>(4, 64 / sizeof(T));
+
+        // Trivially relocatable elements are kept in malloc'd storage so that growth can go through `std::realloc`.
+        static constexpr bool use_realloc = TriviallyRelocatable<T> && alignof(T) <= alignof(std::max_align_t);
+
+        static auto allocate(usize capacity) -> T*;
+        static auto deallocate(T* data) noexcept -> void;
+
+        [[nodiscard]] constexpr auto next_capacity() const noexcept -> usize;
 
         auto realloc(usize capacity) -> void;
 
@@ -123,7 +135,7 @@ namespace flob
         , _size(0)
         , _capacity(0)
     {
-        realloc(count);
+        reserve(count);
         _size = count;
         for (usize i = 0; i < _size; ++i)
         {
@@ -137,7 +149,7 @@ namespace flob
         , _size(0)
         , _capacity(0)
     {
-        realloc(init.size());
+        reserve(init.size());
         for (const T& elem : init)
         {
             new (&_data[_size]) T(elem);
@@ -151,7 +163,7 @@ namespace flob
         , _size(0)
         , _capacity(0)
     {
-        realloc(other._capacity);
+        reserve(other._size);
 
         for (usize i = 0; i < other._size; ++i)
         {
@@ -175,8 +187,7 @@ namespace flob
     constexpr Vector<T>::~Vector() noexcept
     {
         clear();
-        // ::operator delete(_data, _capacity * sizeof(T));
-        ::operator delete(_data);
+        deallocate(_data);
     }
 
     template <typename T>
@@ -185,7 +196,7 @@ namespace flob
         if (this != &other)
         {
             clear();
-            reserve(other._capacity);
+            reserve(other._size);
 
             for (usize i = 0; i < other._size; ++i)
             {
@@ -202,8 +213,7 @@ namespace flob
         if (this != &other)
         {
             clear();
-            // ::operator delete(_data, _capacity * sizeof(T));
-            ::operator delete(_data);
+            deallocate(_data);
 
             _data     = other._data;
             _size     = other._size;
@@ -395,7 +405,7 @@ namespace flob
     {
         if (_size >= _capacity)
         {
-            realloc(_capacity * growth_factor);
+            realloc(next_capacity());
         }
 
         new (&_data[_size]) T(value);
@@ -407,7 +417,7 @@ namespace flob
     {
         if (_size >= _capacity)
         {
-            realloc(_capacity * growth_factor);
+            realloc(next_capacity());
         }
 
         new (&_data[_size]) T(std::move(value));
@@ -420,7 +430,7 @@ namespace flob
     {
         if (_size >= _capacity)
         {
-            realloc(_capacity * growth_factor);
+            realloc(next_capacity());
         }
 
         new (&_data[_size]) T(std::forward<Args>(args)...);
@@ -466,28 +476,80 @@ namespace flob
         _size = size;
     }
 
+    template <typename T>
+    auto Vector<T>::allocate(usize capacity) -> T*
+    {
+        if constexpr (use_realloc)
+        {
+            auto data = static_cast<T*>(std::malloc(capacity * sizeof(T)));
+            if (data == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return data;
+        }
+        else
+        {
+            return static_cast<T*>(::operator new(capacity * sizeof(T)));
+        }
+    }
+
+    template <typename T>
+    auto Vector<T>::deallocate(T* data) noexcept -> void
+    {
+        if constexpr (use_realloc)
+        {
+            std::free(data);
+        }
+        else
+        {
+            ::operator delete(data);
+        }
+    }
+
+    template <typename T>
+    constexpr auto Vector<T>::next_capacity() const noexcept -> usize
+    {
+        return std::max(static_cast<usize>(_capacity * growth_factor), std::max(_capacity + 1, min_capacity));
+    }
+
     template <typename T>
     auto Vector<T>::realloc(usize capacity) -> void
     {
         if (capacity == 0)
         {
-            capacity = 2;
+            capacity = min_capacity;
         }
 
-        T* new_data = static_cast<T*>(::operator new(capacity * sizeof(T)));
-
-        const usize elements_to_copy = (_size < capacity) ? _size : capacity;
-        for (usize i = 0; i < elements_to_copy; ++i)
+        if constexpr (use_realloc)
         {
-            new (&new_data[i]) T(std::move(_data[i]));
+            // Elements past the new capacity are dropped, trivially relocatable types still need their destructor.
+            for (usize i = capacity; i < _size; ++i)
+            {
+                _data[i].~T();
+            }
+
+            auto new_data = static_cast<T*>(std::realloc(_data, capacity * sizeof(T)));
+            if (new_data == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            _data     = new_data;
+            _capacity = capacity;
+            _size     = (_size > capacity) ? capacity : _size;
+            return;
         }
 
-        for (usize i = 0; i < _size; ++i)
+        T* new_data = allocate(capacity);
+
+        const usize elements_to_copy = (_size < capacity) ? _size : capacity;
+        for (usize i = elements_to_copy; i < _size; ++i)
         {
             _data[i].~T();
         }
-        // ::operator delete(_data, _capacity * sizeof(T));
-        ::operator delete(_data);
+        relocate(_data, elements_to_copy, new_data);
+        deallocate(_data);
 
         _data     = new_data;
         _capacity = capacity;
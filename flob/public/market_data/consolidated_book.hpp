@@ -0,0 +1,115 @@
+#pragma once
+
+#include "containers/map.hpp"
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "memory/node_pool.hpp"
+#include "order_book/order.hpp"
+#include "order_book/order_type.hpp"
+#include "order_book/types.hpp"
+
+#include <functional>
+#include <memory>
+
+namespace flob
+{
+    // Displayed quantity at a price summed over the venues quoting it.
+    struct ConsolidatedLevel
+    {
+        Price  price    = invalid_price;
+        uint64 quantity = 0;
+        uint32 venues   = 0;  // Number of venues quoting the price
+
+        auto operator==(const ConsolidatedLevel&) const -> bool = default;
+    };
+
+    // Aggregated view of the same instrument traded on several venues, each of which is a book whose config points
+    // here with its venue index. The books report every change of their displayed quantity, which updates the levels
+    // of that venue and, when its best level changed, the path of the venue up a tournament tree per side. Each match
+    // of the tournament keeps the better price, or sums both when the prices are equal, so the root is the consolidated
+    // best price with its total quantity: O(log venues) per update that reaches a best level, O(1) to read. Depth
+    // merges the level streams of the venues best first through a second tournament over their cursors, in
+    // O(levels * log venues), without copying any venue's depth.
+    //
+    // Books must be empty when they are attached, and the view is only accurate while every attached book is alive.
+    // Single threaded, the books run on the thread that reads the view.
+    class ConsolidatedBook
+    {
+    public:
+        explicit ConsolidatedBook(usize venues);
+
+        ConsolidatedBook(const ConsolidatedBook&) = delete;
+        auto operator=(const ConsolidatedBook&) -> ConsolidatedBook& = delete;
+
+    public:
+        [[nodiscard]] constexpr auto venues() const noexcept -> usize;
+
+        // Best consolidated level of a side, an empty level when no venue quotes it.
+        [[nodiscard]] constexpr auto best(Side side) const noexcept -> const ConsolidatedLevel&;
+
+        // Best level of one venue.
+        [[nodiscard]] constexpr auto best(Side side, usize venue) const noexcept -> const ConsolidatedLevel&;
+
+        // Top `count` consolidated levels of a side, best first, all of them when `count` is 0. Allocation free once
+        // the buffer has grown.
+        auto depth(Side side, usize count, Vector<ConsolidatedLevel>& levels) const -> void;
+
+        // Called by the book of `venue` when the displayed quantity at a price changes by `quantity`.
+        auto update(usize venue, Side side, Price price, int64 quantity) -> void;
+
+    private:
+        template <typename Compare>
+        using LevelMap = Map<Price, Quantity, Compare, PoolAllocator<std::pair<const Price, Quantity>>>;
+
+        using BidLevels = LevelMap<std::greater<Price>>;
+        using AskLevels = LevelMap<std::less<Price>>;
+
+        struct Venue
+        {
+            BidLevels bids;
+            AskLevels asks;
+
+            explicit Venue(NodePool* nodes);
+        };
+
+        template <typename Levels>
+        auto update_levels(Levels& levels, Vector<ConsolidatedLevel>& tree, usize venue, Side side, Price price, int64 quantity) -> void;
+
+        template <typename Levels, typename Cursor>
+        auto merge(Levels Venue::* side_levels, Vector<Cursor>& cursors, Side side, usize count, Vector<ConsolidatedLevel>& levels) const -> void;
+
+    private:
+        std::unique_ptr<NodePool> _nodes;  // Declared first, the level maps release their nodes into it
+        Vector<Venue>             _venues;
+
+        // Tournament trees over a power of two of leaves: node i plays its children 2i and 2i + 1, and venue v is the
+        // leaf at _leaves + v. The root is node 1.
+        usize                     _leaves;
+        Vector<ConsolidatedLevel> _bids;
+        Vector<ConsolidatedLevel> _asks;
+
+        // Scratch of depth(): position of each venue in its levels, and venue whose position is next below each node.
+        mutable Vector<BidLevels::const_iterator> _bid_cursors;
+        mutable Vector<AskLevels::const_iterator> _ask_cursors;
+        mutable Vector<uint32>                    _winners;
+    };
+
+    //==============================================================================================
+    // class : ConsolidatedBook
+    //==============================================================================================
+
+    constexpr auto ConsolidatedBook::venues() const noexcept -> usize
+    {
+        return _venues.size();
+    }
+
+    constexpr auto ConsolidatedBook::best(Side side) const noexcept -> const ConsolidatedLevel&
+    {
+        return (side == Side::Buy ? _bids : _asks)[1];
+    }
+
+    constexpr auto ConsolidatedBook::best(Side side, usize venue) const noexcept -> const ConsolidatedLevel&
+    {
+        return (side == Side::Buy ? _bids : _asks)[_leaves + venue];
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "market_data/shared_book.hpp"
+#include "order_book/order.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace flob
+{
+    struct DepthViewConfig
+    {
+        usize                    levels     = 64;  // Levels per side in a snapshot, 0 for the whole book
+        usize                    slots      = 4;   // Snapshots in rotation, one more than the readers holding one at once
+        std::chrono::nanoseconds interval   = std::chrono::microseconds(100);  // Book time between snapshots
+        usize                    operations = 1024;                            // Operations between snapshots
+    };
+
+    struct DepthSnapshot
+    {
+        uint64              version = 0;  // 0 before the first snapshot, then grows by 1 per snapshot
+        TimePoint           time    = {};  // Book clock when the snapshot was taken
+        Vector<SharedLevel> bids;          // Displayed levels, best first
+        Vector<SharedLevel> asks;
+    };
+
+    // Versioned copies of the displayed depth of a book, for monitoring threads that cannot call infos() while the
+    // matcher runs. The book refreshes the view every `interval` of its clock or every `operations` operations,
+    // whichever comes first, so the writer pays one walk of the top levels per batch of operations rather than per
+    // operation. refresh_view() on the book forces a snapshot, e.g. before it goes idle.
+    //
+    // Snapshots rotate through a few slots in the spirit of RCU. The writer only fills a slot that is neither current
+    // nor held by a reader, then makes it current. A reader pins the current slot with a counter, checks it is still
+    // current, copies it out and unpins it. Neither side ever waits on the other: a writer that finds every slot held
+    // skips the refresh and retries on the next operation, and a reader only retries when a refresh raced with its
+    // pin. One writer, any number of readers.
+    class DepthView
+    {
+    public:
+        explicit DepthView(const DepthViewConfig& config = {});
+
+        DepthView(const DepthView&) = delete;
+        auto operator=(const DepthView&) -> DepthView& = delete;
+
+    public:
+        [[nodiscard]] constexpr auto levels() const noexcept -> usize;
+
+        // Version of the current snapshot, to poll for changes without copying.
+        [[nodiscard]] auto version() const noexcept -> uint64;
+
+        // Consistent copy of the current snapshot. Safe from any thread.
+        auto read(DepthSnapshot& snapshot) const -> void;
+
+        // Writer side, called by the book. Counts an operation and tells whether a refresh is due.
+        [[nodiscard]] auto due(TimePoint now) noexcept -> bool;
+
+        // Slot to fill for the next snapshot, nullptr when every slot is held. Its previous content is stale.
+        [[nodiscard]] auto begin_update() noexcept -> DepthSnapshot*;
+        auto               end_update(TimePoint now) noexcept -> void;
+
+    private:
+        struct alignas(64) Slot
+        {
+            std::atomic<uint32> readers = 0;
+            DepthSnapshot       snapshot;
+        };
+
+    private:
+        DepthViewConfig         _config;
+        std::unique_ptr<Slot[]> _slots;
+
+        alignas(64) std::atomic<usize> _current;
+        std::atomic<uint64>            _version;
+
+        // Writer only.
+        alignas(64) usize _next       = 0;  // Slot being filled between begin_update() and end_update()
+        usize             _operations = 0;
+        TimePoint         _published  = {};
+    };
+
+    //==============================================================================================
+    // class : DepthView
+    //==============================================================================================
+
+    constexpr auto DepthView::levels() const noexcept -> usize
+    {
+        return _config.levels;
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "analytics/feature_stream.hpp"
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "order_book/order.hpp"
+#include "order_book/types.hpp"
+
+#include <array>
+#include <atomic>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace flob
+{
+    // Deepest book that can be published, readers size their snapshots with it.
+    constexpr usize max_shared_depth = 32;
+
+    struct SharedLevel
+    {
+        Price    price    = invalid_price;
+        Quantity quantity = 0;
+
+        auto operator==(const SharedLevel&) const -> bool = default;
+    };
+
+    struct SharedBookSnapshot
+    {
+        uint64                                    sequence   = 0;  // Even, grows by 2 per published update
+        TimePoint                                 time       = {};
+        Price                                     last_price = invalid_price;
+        usize                                     bid_count  = 0;
+        usize                                     ask_count  = 0;
+        std::array<SharedLevel, max_shared_depth> bids;  // Best first, only the first `bid_count` are meaningful
+        std::array<SharedLevel, max_shared_depth> asks;
+
+        [[nodiscard]] constexpr auto top() const noexcept -> TopOfBook;
+    };
+
+    // Layout of the shared memory region. The sequence is the seqlock: odd while the writer is storing, even when the
+    // words are consistent. The words follow on the same cache line: time in nanoseconds, last price, then `depth`
+    // bid levels and `depth` ask levels, each packed as (price << 32 | quantity). An empty level is invalid_price with
+    // no quantity. Every word is an atomic so that racing reads are relaxed loads rather than undefined behavior, they
+    // compile to plain moves.
+    struct SharedBookHeader
+    {
+        char   magic[8];  // "FLOBBOOK"
+        uint32 version;
+        uint32 depth;
+        uint64 reserved[6];
+    };
+
+    static_assert(sizeof(SharedBookHeader) == 64, "The sequence starts on its own cache line");
+    static_assert(std::atomic<uint64>::is_always_lock_free, "Seqlock words must be lock free to live in shared memory");
+
+    // Writer of the current top of book and top `depth` levels of a book into a named POSIX shared memory region, for
+    // risk, UI and strategy processes on the same host. After each public operation that reached the published levels,
+    // the book restages them and commits. A commit stores the sequence twice plus the words that changed, nothing at
+    // all when no level did. Readers never block the writer. Move only, one writer per name.
+    class BookPublisher
+    {
+    public:
+        static constexpr uint32 version = 1;
+
+    public:
+        BookPublisher() noexcept = default;
+        ~BookPublisher() noexcept;
+
+        BookPublisher(const BookPublisher&) = delete;
+        BookPublisher(BookPublisher&& other) noexcept;
+
+        auto operator=(const BookPublisher&) -> BookPublisher& = delete;
+        auto operator=(BookPublisher&& other) noexcept -> BookPublisher&;
+
+    public:
+        // Creates or replaces the region `name` (e.g. "/flob.book") for `depth` levels per side, at most
+        // max_shared_depth. Empty on failure. The region is removed with the publisher.
+        [[nodiscard]] static auto create(std::string_view name, usize depth) -> BookPublisher;
+
+    public:
+        [[nodiscard]] constexpr auto empty() const noexcept -> bool;
+        [[nodiscard]] constexpr auto depth() const noexcept -> usize;
+
+        // Private staging area of a side, `depth` levels long, best first and padded with empty levels. It keeps its
+        // content between commits, a side that did not change does not need to be staged again.
+        auto stage(Side side) noexcept -> std::span<SharedLevel>;
+
+        // Price of the last staged level of the side, invalid_price while the side has fewer levels than the depth.
+        // Changes at worse prices cannot reach the published levels.
+        [[nodiscard]] auto boundary(Side side) const noexcept -> Price;
+
+        // Publishes the staged levels when they differ from the last commit. True when readers see a new version.
+        auto commit(TimePoint time, Price last_price) noexcept -> bool;
+
+    private:
+        BookPublisher(std::string name, std::byte* data, usize size, usize depth) noexcept;
+
+        auto release() noexcept -> void;
+
+    private:
+        std::string          _name;
+        std::byte*           _data     = nullptr;
+        usize                _size     = 0;
+        usize                _depth    = 0;
+        std::atomic<uint64>* _sequence = nullptr;
+        std::atomic<uint64>* _words    = nullptr;
+        Vector<SharedLevel>  _staged;     // Bids then asks
+        Vector<uint64>       _published;  // Last committed words, compared before storing anything
+    };
+
+    // Read side of a BookPublisher region. Reads copy the words between two loads of the sequence and retry when the
+    // writer was in between, they never write to the region.
+    class BookReader
+    {
+    public:
+        BookReader() noexcept = default;
+        ~BookReader() noexcept;
+
+        BookReader(const BookReader&) = delete;
+        BookReader(BookReader&& other) noexcept;
+
+        auto operator=(const BookReader&) -> BookReader& = delete;
+        auto operator=(BookReader&& other) noexcept -> BookReader&;
+
+    public:
+        // Empty when the region does not exist or was written by another version.
+        [[nodiscard]] static auto open(std::string_view name) -> BookReader;
+
+    public:
+        [[nodiscard]] constexpr auto empty() const noexcept -> bool;
+        [[nodiscard]] constexpr auto depth() const noexcept -> usize;
+
+        // Sequence of the last published update, to poll for changes without copying.
+        [[nodiscard]] auto sequence() const noexcept -> uint64;
+
+        // Consistent copy of the whole region.
+        auto read(SharedBookSnapshot& snapshot) const noexcept -> void;
+
+        // Consistent copy of the best levels only, a handful of loads.
+        [[nodiscard]] auto top() const noexcept -> TopOfBook;
+
+    private:
+        BookReader(const std::byte* data, usize size, usize depth) noexcept;
+
+        auto release() noexcept -> void;
+
+    private:
+        const std::byte*           _data     = nullptr;
+        usize                      _size     = 0;
+        usize                      _depth    = 0;
+        const std::atomic<uint64>* _sequence = nullptr;
+        const std::atomic<uint64>* _words    = nullptr;
+    };
+
+    //==============================================================================================
+    // struct : SharedBookSnapshot
+    //==============================================================================================
+
+    constexpr auto SharedBookSnapshot::top() const noexcept -> TopOfBook
+    {
+        return TopOfBook(bids[0].price, bids[0].quantity, asks[0].price, asks[0].quantity);
+    }
+
+    //==============================================================================================
+    // class : BookPublisher
+    //==============================================================================================
+
+    constexpr auto BookPublisher::empty() const noexcept -> bool
+    {
+        return _data == nullptr;
+    }
+
+    constexpr auto BookPublisher::depth() const noexcept -> usize
+    {
+        return _depth;
+    }
+
+    //==============================================================================================
+    // class : BookReader
+    //==============================================================================================
+
+    constexpr auto BookReader::empty() const noexcept -> bool
+    {
+        return _data == nullptr;
+    }
+
+    constexpr auto BookReader::depth() const noexcept -> usize
+    {
+        return _depth;
+    }
+}
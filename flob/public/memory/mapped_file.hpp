@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core_types.hpp"
+#include "memory/pages.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+namespace flob
+{
+    // Zero-filled memory of a fixed size, either anonymous or backed by a file that other processes can map at the
+    // same time, e.g. numpy.memmap for analysis while a run is still writing. Move only.
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept = default;
+        ~MappedFile() noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+
+        auto operator=(const MappedFile&) -> MappedFile& = delete;
+        auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+    public:
+        // Creates or truncates the file at `path` to `size` bytes and maps it, anonymous memory when the path is
+        // empty. Empty on failure.
+        [[nodiscard]] static auto map(std::string_view path, usize size) -> MappedFile;
+
+        // Anonymous memory backed as configured, aligned to a huge page when huge pages are asked for. Explicit huge
+        // pages round the size up to a whole number of them, and fall back to transparent ones when none are
+        // reserved. Empty on failure.
+        [[nodiscard]] static auto anonymous(usize size, const PageConfig& pages) -> MappedFile;
+
+    public:
+        [[nodiscard]] constexpr auto empty() const noexcept -> bool;
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+        [[nodiscard]] constexpr auto is_file() const noexcept -> bool;
+
+        constexpr auto               data() noexcept -> std::byte*;
+        [[nodiscard]] constexpr auto data() const noexcept -> const std::byte*;
+
+        // Schedules the write back of dirty pages, a no-op for anonymous memory.
+        auto sync() noexcept -> void;
+
+    private:
+        MappedFile(std::byte* data, usize size, bool is_file) noexcept;
+
+        auto unmap() noexcept -> void;
+
+    private:
+        std::byte* _data    = nullptr;
+        usize      _size    = 0;
+        bool       _is_file = false;
+    };
+
+    //==============================================================================================
+    // class : MappedFile
+    //==============================================================================================
+
+    constexpr auto MappedFile::empty() const noexcept -> bool
+    {
+        return _data == nullptr;
+    }
+
+    constexpr auto MappedFile::size() const noexcept -> usize
+    {
+        return _size;
+    }
+
+    constexpr auto MappedFile::is_file() const noexcept -> bool
+    {
+        return _is_file;
+    }
+
+    constexpr auto MappedFile::data() noexcept -> std::byte*
+    {
+        return _data;
+    }
+
+    constexpr auto MappedFile::data() const noexcept -> const std::byte*
+    {
+        return _data;
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "memory/mapped_file.hpp"
+#include "memory/pages.hpp"
+
+#include <cstddef>
+#include <new>
+
+namespace flob
+{
+    // Free lists of small blocks carved from large chunks, for node based containers whose nodes come and go with the
+    // flow, e.g. the price levels of a book. A freed block goes back to the list of its size and is handed out first,
+    // so once the pool has grown to the peak population it stops allocating. Chunks come from the heap, or are mapped in
+    // whole huge pages when the page config asks for them, and are only released with the pool. Single threaded.
+    class NodePool
+    {
+    public:
+        static constexpr usize granularity    = 16;   // Block sizes are rounded up to a multiple, also their alignment
+        static constexpr usize max_block_size = 256;  // Larger requests go to operator new
+        static constexpr usize chunk_size     = 64 * 1024;
+
+        explicit NodePool(const PageConfig& pages = {}) noexcept;
+        ~NodePool() noexcept;
+
+        NodePool(const NodePool&) = delete;
+        auto operator=(const NodePool&) -> NodePool& = delete;
+
+    public:
+        // Bytes held by the chunks, free blocks included.
+        [[nodiscard]] constexpr auto memory_usage() const noexcept -> usize;
+
+        [[nodiscard]] auto allocate(usize size) -> void*;
+        auto               deallocate(void* block, usize size) noexcept -> void;
+
+        // Carves `count` blocks of `size` bytes up front, so that the first `count` allocations of that size do not
+        // grow the pool.
+        auto reserve(usize size, usize count) -> void;
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        static constexpr usize class_count = max_block_size / granularity;
+
+        [[nodiscard]] static constexpr auto size_class(usize size) noexcept -> usize;
+
+        auto carve(usize size_class) -> void*;
+
+    private:
+        PageConfig         _pages;
+        Vector<void*>      _chunks;         // Heap chunks, with regular pages
+        Vector<MappedFile> _mapped_chunks;  // Huge page chunks
+        std::byte*         _cursor            = nullptr;  // Unused tail of the last chunk
+        std::byte*         _end               = nullptr;
+        usize              _memory_usage      = 0;
+        FreeBlock*         _free[class_count] = {};
+    };
+
+    // Standard allocator over a NodePool, to give a Map pooled nodes. Copies and rebinds share the pool, which must
+    // outlive every container using it. Without a pool it falls back to operator new.
+    template <typename T>
+    class PoolAllocator
+    {
+    public:
+        using value_type = T;
+
+        constexpr PoolAllocator() noexcept = default;
+        constexpr PoolAllocator(NodePool* pool) noexcept;
+
+        template <typename U>
+        constexpr PoolAllocator(const PoolAllocator<U>& other) noexcept;
+
+    public:
+        [[nodiscard]] constexpr auto pool() const noexcept -> NodePool*;
+
+        [[nodiscard]] auto allocate(usize count) -> T*;
+        auto               deallocate(T* pointer, usize count) noexcept -> void;
+
+        template <typename U>
+        [[nodiscard]] constexpr auto operator==(const PoolAllocator<U>& other) const noexcept -> bool;
+
+    private:
+        NodePool* _pool = nullptr;
+    };
+
+    //==============================================================================================
+    // class : NodePool
+    //==============================================================================================
+
+    constexpr auto NodePool::memory_usage() const noexcept -> usize
+    {
+        return _memory_usage;
+    }
+
+    constexpr auto NodePool::size_class(usize size) noexcept -> usize
+    {
+        return (size + granularity - 1) / granularity - 1;
+    }
+
+    //==============================================================================================
+    // class : PoolAllocator
+    //==============================================================================================
+
+    template <typename T>
+    constexpr PoolAllocator<T>::PoolAllocator(NodePool* pool) noexcept
+        : _pool(pool)
+    {}
+
+    template <typename T>
+    template <typename U>
+    constexpr PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>& other) noexcept
+        : _pool(other.pool())
+    {}
+
+    template <typename T>
+    constexpr auto PoolAllocator<T>::pool() const noexcept -> NodePool*
+    {
+        return _pool;
+    }
+
+    template <typename T>
+    auto PoolAllocator<T>::allocate(usize count) -> T*
+    {
+        static_assert(alignof(T) <= NodePool::granularity, "Pooled blocks are only aligned to the pool granularity");
+        return static_cast<T*>(_pool ? _pool->allocate(count * sizeof(T)) : ::operator new(count * sizeof(T)));
+    }
+
+    template <typename T>
+    auto PoolAllocator<T>::deallocate(T* pointer, usize count) noexcept -> void
+    {
+        if (_pool)
+        {
+            _pool->deallocate(pointer, count * sizeof(T));
+            return;
+        }
+        ::operator delete(pointer);
+    }
+
+    template <typename T>
+    template <typename U>
+    constexpr auto PoolAllocator<T>::operator==(const PoolAllocator<U>& other) const noexcept -> bool
+    {
+        return _pool == other.pool();
+    }
+}
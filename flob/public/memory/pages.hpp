@@ -0,0 +1,28 @@
+#pragma once
+
+#include "core_types.hpp"
+
+namespace flob
+{
+    enum class HugePages : uint8
+    {
+        Off,          // Regular pages
+        Transparent,  // Ask the kernel to back the memory with transparent huge pages where it can
+        Explicit,     // Reserved huge pages (MAP_HUGETLB) for own mappings, transparent ones otherwise
+    };
+
+    // How large preallocated structures are backed. Huge pages cut the TLB misses of random accesses over millions of
+    // orders, pre-faulting moves the page faults of the first operations to startup.
+    struct PageConfig
+    {
+        HugePages huge_pages = HugePages::Off;
+        bool      prefault   = false;
+    };
+
+    constexpr usize huge_page_size = 2 * 1024 * 1024;
+
+    // Applies the config to memory that is already allocated, e.g. the reserved storage of a Vector: transparent huge
+    // pages for the whole huge pages it spans, then a pre-fault of every page. Contents are preserved. A no-op where
+    // the platform has no such controls.
+    auto prepare_pages(void* data, usize size, const PageConfig& pages) noexcept -> void;
+}
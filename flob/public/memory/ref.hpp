@@ -1,5 +1,7 @@
 #pragma once
 
+#include "memory/trivially_relocatable.hpp"
+
 #include <cstddef>
 #include <type_traits>
 #include <utility>
@@ -88,6 +90,10 @@ namespace flob
         return Ref<T>(new T(std::forward<Args>(args)...));
     }
 
+    // A Ref is a single owning pointer, relocating it never needs to touch the reference count.
+    template <RefCountable T>
+    inline constexpr bool enable_trivially_relocatable<Ref<T>> = true;
+
     //==============================================================================================
     // class : Ref
     //==============================================================================================
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core_types.hpp"
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace flob
+{
+    // A type is trivially relocatable when moving it to a new address and ending the lifetime of the source is
+    // equivalent to a memcpy. Specialize `enable_trivially_relocatable` for types that own resources through a plain
+    // pointer (e.g. Ref<T>) but are not trivially copyable.
+    template <typename T>
+    inline constexpr bool enable_trivially_relocatable = std::is_trivially_copyable_v<T>;
+
+    template <typename T>
+    concept TriviallyRelocatable = enable_trivially_relocatable<std::remove_cv_t<T>>;
+
+    // Moves `count` objects from `source` into the uninitialized storage at `destination` and ends their lifetime at
+    // the source. The two ranges must not overlap.
+    template <typename T>
+    auto relocate(T* source, usize count, T* destination) noexcept -> void
+    {
+        if constexpr (TriviallyRelocatable<T>)
+        {
+            if (count > 0)
+            {
+                std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(T));
+            }
+        }
+        else
+        {
+            for (usize i = 0; i < count; ++i)
+            {
+                new (&destination[i]) T(std::move(source[i]));
+                source[i].~T();
+            }
+        }
+    }
+}
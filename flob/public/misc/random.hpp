@@ -0,0 +1,119 @@
+#pragma once
+
+#include "core_types.hpp"
+
+#include <bit>
+#include <cmath>
+
+namespace flob
+{
+    // Small, seedable xoshiro256** generator. Much cheaper than std::mt19937_64 and fully reproducible across platforms,
+    // which the standard distributions are not.
+    class Random final
+    {
+    public:
+        explicit constexpr Random(uint64 seed = 0x9E3779B97F4A7C15ull) noexcept;
+
+    public:
+        constexpr auto next() noexcept -> uint64;
+
+        // Uniform integer in [0, bound).
+        constexpr auto uniform(uint64 bound) noexcept -> uint64;
+
+        // Uniform integer in [min, max].
+        constexpr auto range(int64 min, int64 max) noexcept -> int64;
+
+        // Uniform real in [0, 1).
+        constexpr auto real() noexcept -> float64;
+
+        constexpr auto bernoulli(float64 probability) noexcept -> bool;
+
+        auto exponential(float64 rate) noexcept -> float64;
+
+        // Number of failures before the first success, capped at `max`.
+        auto geometric(float64 probability, uint32 max) noexcept -> uint32;
+
+    private:
+        static constexpr auto split_mix(uint64& state) noexcept -> uint64;
+
+    private:
+        uint64 _state[4];
+    };
+
+    //==============================================================================================
+    // class : Random
+    //==============================================================================================
+
+    constexpr Random::Random(uint64 seed) noexcept
+        : _state()
+    {
+        for (auto& state : _state)
+        {
+            state = split_mix(seed);
+        }
+    }
+
+    constexpr auto Random::next() noexcept -> uint64
+    {
+        const auto result = std::rotl(_state[1] * 5, 7) * 9;
+        const auto t      = _state[1] << 17;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = std::rotl(_state[3], 45);
+
+        return result;
+    }
+
+    constexpr auto Random::uniform(uint64 bound) noexcept -> uint64
+    {
+#if defined(__SIZEOF_INT128__)
+        // Lemire's multiply-shift reduction, the bias is negligible for the bounds used here.
+        return static_cast<uint64>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+#else
+        return next() % bound;
+#endif
+    }
+
+    constexpr auto Random::range(int64 min, int64 max) noexcept -> int64
+    {
+        return min + static_cast<int64>(uniform(static_cast<uint64>(max - min) + 1));
+    }
+
+    constexpr auto Random::real() noexcept -> float64
+    {
+        return static_cast<float64>(next() >> 11) * 0x1.0p-53;
+    }
+
+    constexpr auto Random::bernoulli(float64 probability) noexcept -> bool
+    {
+        return real() < probability;
+    }
+
+    inline auto Random::exponential(float64 rate) noexcept -> float64
+    {
+        return -std::log1p(-real()) / rate;
+    }
+
+    inline auto Random::geometric(float64 probability, uint32 max) noexcept -> uint32
+    {
+        if (probability >= 1.0)
+        {
+            return 0;
+        }
+
+        const auto value = std::floor(std::log1p(-real()) / std::log1p(-probability));
+        return value >= max ? max : static_cast<uint32>(value);
+    }
+
+    constexpr auto Random::split_mix(uint64& state) noexcept -> uint64
+    {
+        auto z = (state += 0x9E3779B97F4A7C15ull);
+        z      = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z      = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+}
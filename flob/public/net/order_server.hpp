@@ -0,0 +1,126 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "order_book/order_book.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace flob
+{
+    struct OrderServerConfig
+    {
+        std::string path            = "/tmp/flob.sock";  // Unix domain socket, replaced when it already exists
+        uint16      port            = 0;                 // Listens on loopback TCP instead when non-zero
+        bool        busy_poll       = false;             // Spins on the event loop instead of sleeping in the kernel
+        usize       buffer_size     = 64 * 1024;         // Per connection receive buffer, and send backlog limit
+        usize       max_backlog     = 16 * 1024 * 1024;  // Send backlog at which a connection is dropped
+        usize       max_connections = 64;
+    };
+
+    struct OrderServerStats
+    {
+        uint64 connections    = 0;
+        uint64 messages       = 0;
+        uint64 trades         = 0;
+        uint64 bytes_received = 0;
+        uint64 bytes_sent     = 0;
+        uint64 wakeups        = 0;  // Event loop iterations that returned at least one event
+    };
+
+    // Single threaded order entry gateway in front of a book. Clients connect over a Unix domain socket or loopback
+    // TCP and stream the binary protocol of order_entry.hpp. Everything a receive brings in is applied to the book as
+    // one batch, and the responses go back to the sending connection in one send.
+    //
+    // Every connection is a session with its own id namespace: in the book, the ids of its orders carry the session
+    // above the client id, which must fit in 40 bits. A session thus never cancels or replaces the orders of another
+    // one, and executions go to the sessions owning either side, each seeing its own ids and 0 for the other side.
+    // Orders outlive their session, so a connection slot is retired after 2^(24 - log2 max_connections) - 1 sessions,
+    // before the namespaces it hands out would wrap around.
+    //
+    // A session also trades for a single account, the one of its first entry, which no other open session may hold at
+    // the time. Entries for any other account are rejected, so a connection cannot spend the risk limits or take the
+    // PnL of an account another one is trading. The protocol has no login: a session claims its account, it does not
+    // prove it. invalid_account is never held and leaves the orders unchecked, as everywhere.
+    //
+    // The loop is level triggered epoll. A connection whose send backlog exceeds its buffer is not read again until
+    // the client drains it, so a slow reader throttles itself rather than the server. Executions keep coming from the
+    // other sessions though, a connection whose backlog still reaches max_backlog is dropped. A malformed stream also
+    // closes the connection. Linux only, start() fails elsewhere.
+    class OrderServer
+    {
+    public:
+        explicit OrderServer(OrderBook& book, const OrderServerConfig& config = {});
+        ~OrderServer() noexcept;
+
+        OrderServer(const OrderServer&) = delete;
+        auto operator=(const OrderServer&) -> OrderServer& = delete;
+
+    public:
+        // Binds and listens. False when the socket cannot be set up.
+        [[nodiscard]] auto start() -> bool;
+
+        // Serves until stop().
+        auto run() -> void;
+
+        // Handles the events that are ready, waiting up to `timeout` for the first one. Returns the number handled.
+        auto poll(std::chrono::milliseconds timeout) -> usize;
+
+        // Makes run() return, callable from another thread or a signal handler.
+        auto stop() noexcept -> void;
+
+        [[nodiscard]] constexpr auto stats() const noexcept -> const OrderServerStats&;
+
+    private:
+        struct Connection
+        {
+            int32                    fd = -1;
+            Vector<std::byte>        rx;
+            usize                    rx_size = 0;
+            Vector<std::byte>        tx;
+            usize                    tx_sent    = 0;      // Bytes of tx already written to the socket
+            uint32                   events     = 0;      // Interest registered with epoll
+            uint64                   session    = 0;      // Namespace of the ids of its orders in the book
+            uint32                   generation = 0;      // Sessions the slot has served
+            std::optional<AccountId> account;             // Account of the session, set by its first entry
+            bool                     notified   = false;  // Output pending from the batch of another connection
+        };
+
+        auto accept_connections() -> void;
+        auto close_connection(usize slot) -> void;
+        auto on_readable(usize slot) -> void;
+        auto send(usize slot, std::span<const std::byte> message) -> void;
+        auto report_execution(const Trade& trade) -> void;
+        auto owner(OrderId order_id) const noexcept -> usize;
+        auto claim_account(usize slot, AccountId account) noexcept -> bool;
+        auto flush(usize slot) -> void;
+        auto update_interest(usize slot) -> void;
+
+    private:
+        OrderBook&        _book;
+        OrderServerConfig _config;
+        OrderServerStats  _stats;
+
+        int32              _epoll  = -1;
+        int32              _listen = -1;
+        int32              _wakeup = -1;  // eventfd written by stop()
+        std::atomic<bool>  _running;
+        Vector<Connection> _connections;
+        uint32             _slot_bits = 0;  // Low bits of a session holding its slot
+        Vector<usize>      _notified;       // Connections other than the sender given output by the current batch
+    };
+
+    //==============================================================================================
+    // class : OrderServer
+    //==============================================================================================
+
+    constexpr auto OrderServer::stats() const noexcept -> const OrderServerStats&
+    {
+        return _stats;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "order_book/order.hpp"
+#include "order_book/order_type.hpp"
+#include "order_book/types.hpp"
+
+namespace flob
+{
+    enum class CommandType : uint8
+    {
+        Add,
+        Cancel,
+        Modify,
+    };
+
+    // Outcome of a command: whether the book took the order, and why not otherwise.
+    enum class OrderStatus : uint8
+    {
+        Accepted,      // Taken by the book, which may have traded it in full on arrival
+        DuplicateId,   // Another order of the book has the id
+        Expired,       // GTT order already past its expiry
+        RiskLimit,     // Failed a pre-trade risk check
+        Auction,       // IOC or market order during a call period
+        NoLiquidity,   // Market order facing an empty side
+        WouldCross,    // Post-only order that would take liquidity
+        UnknownOrder,  // Cancel or replace of an order that is not in the book
+        Invalid,       // Unknown side or command type
+    };
+
+    // Plain description of a book operation. Unlike Order it owns nothing, so large batches can be generated or decoded
+    // up front and applied later with OrderBook::apply().
+    struct OrderCommand
+    {
+        uint64      timestamp;                      // Nanoseconds since the start of the flow
+        OrderId     id;
+        Price       price;                          // invalid_price for market orders
+        Quantity    quantity;
+        CommandType type;
+        OrderType   order_type;
+        Side        side;
+        OrderFlags  flags         = OrderFlags::None;
+        Quantity    peak_quantity = 0;              // Displayed slice of iceberg orders, 0 otherwise
+        Price       stop_price    = invalid_price;  // Trigger price of stop orders
+        TimePoint   expiry        = {};             // Expiry of GTT orders
+        AccountId   account       = invalid_account;
+    };
+}
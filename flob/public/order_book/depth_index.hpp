@@ -0,0 +1,102 @@
+#pragma once
+
+#include "containers/fenwick_tree.hpp"
+#include "core_types.hpp"
+#include "order_book/order.hpp"
+#include "order_book/order_type.hpp"
+#include "order_book/types.hpp"
+
+namespace flob
+{
+    struct ExecutionCost
+    {
+        Quantity quantity;     // Executable quantity, below the requested one when the side runs out
+        uint64   notional;     // Sum of price * quantity over the fills
+        Price    worst_price;  // Last level reached, invalid_price when nothing executes
+
+        [[nodiscard]] constexpr auto vwap() const noexcept -> float64;
+    };
+
+    // Displayed quantity and notional per price over a fixed price range, in Fenwick trees ordered best price first
+    // for each side. The book keeps it up to date on every change of displayed quantity, and execution cost queries
+    // then cost O(log range) instead of a walk over the levels. Levels outside the range are not indexed.
+    class DepthIndex
+    {
+    public:
+        DepthIndex() noexcept = default;
+        DepthIndex(Price min_price, Price max_price) noexcept;
+
+    public:
+        [[nodiscard]] constexpr auto enabled() const noexcept -> bool;
+
+        constexpr auto add(Side side, Price price, int64 quantity) noexcept -> void;
+
+        // Queries take the resting side being looked at, e.g. Side::Sell for the cost of buying.
+
+        // Cost of taking `quantity` from the side, best price first.
+        [[nodiscard]] auto cost(Side side, Quantity quantity) const noexcept -> ExecutionCost;
+
+        // Worst price reached when taking `quantity`, invalid_price when the side holds less.
+        [[nodiscard]] auto price_for(Side side, Quantity quantity) const noexcept -> Price;
+
+        // Displayed quantity within `ticks` of the best price of the side, both ends included.
+        [[nodiscard]] auto depth(Side side, Price ticks) const noexcept -> Quantity;
+
+    private:
+        struct Ladder
+        {
+            FenwickTree<int64> quantities;
+            FenwickTree<int64> notionals;
+        };
+
+        [[nodiscard]] constexpr auto index(Side side, Price price) const noexcept -> usize;
+        [[nodiscard]] constexpr auto price(Side side, usize index) const noexcept -> Price;
+
+    private:
+        Price  _min_price = 0;
+        Price  _max_price = 0;
+        Ladder _bids;  // Indexed from the highest price down
+        Ladder _asks;  // Indexed from the lowest price up
+    };
+
+    //==============================================================================================
+    // struct : ExecutionCost
+    //==============================================================================================
+
+    constexpr auto ExecutionCost::vwap() const noexcept -> float64
+    {
+        return quantity == 0 ? 0.0 : static_cast<float64>(notional) / quantity;
+    }
+
+    //==============================================================================================
+    // class : DepthIndex
+    //==============================================================================================
+
+    constexpr auto DepthIndex::enabled() const noexcept -> bool
+    {
+        return _bids.quantities.size() > 0;
+    }
+
+    constexpr auto DepthIndex::add(Side side, Price price, int64 quantity) noexcept -> void
+    {
+        if (!enabled() || price < _min_price || price > _max_price || quantity == 0)
+        {
+            return;
+        }
+
+        auto&      ladder = side == Side::Buy ? _bids : _asks;
+        const auto i      = index(side, price);
+        ladder.quantities.add(i, quantity);
+        ladder.notionals.add(i, quantity * price);
+    }
+
+    constexpr auto DepthIndex::index(Side side, Price price) const noexcept -> usize
+    {
+        return side == Side::Buy ? _max_price - price : price - _min_price;
+    }
+
+    constexpr auto DepthIndex::price(Side side, usize index) const noexcept -> Price
+    {
+        return side == Side::Buy ? _max_price - static_cast<Price>(index) : _min_price + static_cast<Price>(index);
+    }
+}
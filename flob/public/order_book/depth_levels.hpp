@@ -0,0 +1,95 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "order_book/depth_index.hpp"
+#include "order_book/order.hpp"
+#include "order_book/types.hpp"
+
+namespace flob
+{
+    // Displayed levels of one side, best first, with prices and quantities in separate contiguous arrays so that
+    // cumulative depth, VWAP and sweep queries run as the vector kernels the CPU supports. Filled by depth_levels() on
+    // the book, then queried without it. Unlike the DepthIndex it covers any price, at O(levels) per query.
+    class DepthLevels
+    {
+    public:
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+        [[nodiscard]] constexpr auto empty() const noexcept -> bool;
+
+        [[nodiscard]] constexpr auto prices() const noexcept -> const Vector<Price>&;
+        [[nodiscard]] constexpr auto quantities() const noexcept -> const Vector<Quantity>&;
+
+        // Filled by resizing first, then setting each level, which keeps the fill loop free of capacity checks.
+        constexpr auto clear() noexcept -> void;
+        constexpr auto reserve(usize levels) noexcept -> void;
+        constexpr auto resize(usize levels) noexcept -> void;
+        constexpr auto set(usize index, Price price, Quantity quantity) noexcept -> void;
+
+        // Displayed quantity over the first `levels` levels, all of them past the end.
+        [[nodiscard]] auto quantity(usize levels) const noexcept -> uint64;
+
+        // cumulative[i] is the displayed quantity of levels 0 to i.
+        auto cumulative(Vector<uint64>& cumulative) const noexcept -> void;
+
+        // Average price of the first `levels` levels weighted by their quantity, NaN when they hold nothing.
+        [[nodiscard]] auto vwap(usize levels) const noexcept -> float64;
+
+        // Cost of taking `quantity`, best price first, and the worst price it reaches, as DepthIndex::cost() and
+        // DepthIndex::price_for() compute them.
+        [[nodiscard]] auto cost(Quantity quantity) const noexcept -> ExecutionCost;
+        [[nodiscard]] auto price_for(Quantity quantity) const noexcept -> Price;
+
+    private:
+        Vector<Price>    _prices;
+        Vector<Quantity> _quantities;
+    };
+
+    //==============================================================================================
+    // class : DepthLevels
+    //==============================================================================================
+
+    constexpr auto DepthLevels::size() const noexcept -> usize
+    {
+        return _prices.size();
+    }
+
+    constexpr auto DepthLevels::empty() const noexcept -> bool
+    {
+        return _prices.empty();
+    }
+
+    constexpr auto DepthLevels::prices() const noexcept -> const Vector<Price>&
+    {
+        return _prices;
+    }
+
+    constexpr auto DepthLevels::quantities() const noexcept -> const Vector<Quantity>&
+    {
+        return _quantities;
+    }
+
+    constexpr auto DepthLevels::clear() noexcept -> void
+    {
+        _prices.clear();
+        _quantities.clear();
+    }
+
+    constexpr auto DepthLevels::reserve(usize levels) noexcept -> void
+    {
+        _prices.reserve(levels);
+        _quantities.reserve(levels);
+    }
+
+    constexpr auto DepthLevels::resize(usize levels) noexcept -> void
+    {
+        _prices.resize(levels);
+        _quantities.resize(levels);
+    }
+
+    constexpr auto DepthLevels::set(usize index, Price price, Quantity quantity) noexcept -> void
+    {
+        _prices[index]     = price;
+        _quantities[index] = quantity;
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "order_book/order_pool.hpp"
+#include "order_book/types.hpp"
+
+#include <algorithm>
+
+namespace flob
+{
+    struct MatchingConfig
+    {
+        AccountId lead_market_maker = invalid_account;
+        uint32    lmm_allocation    = 0;  // Percent of every incoming quantity allocated to the lead market maker first
+    };
+
+    // Matching policies split an incoming quantity across the orders of the best opposite level. `match` calls
+    // `fill(handle, quantity)` for every allocation, the book then records the trade and erases or replenishes the
+    // resting order, so policies must step to the next order before calling `fill`. Allocations never exceed the
+    // remaining quantity of an order nor, in total, the incoming quantity.
+
+    // Strict price-time priority.
+    class FifoMatching
+    {
+    public:
+        explicit constexpr FifoMatching(const MatchingConfig& config = {}) noexcept;
+
+    public:
+        template <typename Level, typename Fill>
+        constexpr auto match(const OrderPool& orders, const Level& level, Quantity quantity, Fill&& fill) const -> void;
+    };
+
+    // Fills are split in proportion to the resting quantities, using the level aggregate as the denominator so the
+    // queue is only walked once. Shares are rounded on the running total, which keeps each of them within one lot of its
+    // exact value, makes them sum to the incoming quantity and only depends on the queue order.
+    class ProRataMatching
+    {
+    public:
+        explicit constexpr ProRataMatching(const MatchingConfig& config = {}) noexcept;
+
+    public:
+        template <typename Level, typename Fill>
+        constexpr auto match(const OrderPool& orders, const Level& level, Quantity quantity, Fill&& fill) const -> void;
+    };
+
+    // Price-time priority after the lead market maker has received its allocation at the level.
+    class LmmMatching
+    {
+    public:
+        explicit constexpr LmmMatching(const MatchingConfig& config = {}) noexcept;
+
+    public:
+        template <typename Level, typename Fill>
+        constexpr auto match(const OrderPool& orders, const Level& level, Quantity quantity, Fill&& fill) const -> void;
+
+    private:
+        AccountId _lead_market_maker;
+        uint32    _allocation;
+    };
+
+    //==============================================================================================
+    // class : FifoMatching
+    //==============================================================================================
+
+    constexpr FifoMatching::FifoMatching(const MatchingConfig&) noexcept
+    {}
+
+    template <typename Level, typename Fill>
+    constexpr auto FifoMatching::match(const OrderPool& orders, const Level& level, Quantity quantity, Fill&& fill) const -> void
+    {
+        // An exhausted iceberg slice moves to the tail, so the front is always the next order in line.
+        while (quantity > 0 && !level.orders.empty())
+        {
+            const auto handle = level.orders.head;
+            const auto filled = std::min(quantity, orders[handle].remaining_quantity);
+
+            quantity -= filled;
+            fill(handle, filled);
+        }
+    }
+
+    //==============================================================================================
+    // class : ProRataMatching
+    //==============================================================================================
+
+    constexpr ProRataMatching::ProRataMatching(const MatchingConfig&) noexcept
+    {}
+
+    template <typename Level, typename Fill>
+    constexpr auto ProRataMatching::match(const OrderPool& orders, const Level& level, Quantity quantity, Fill&& fill) const -> void
+    {
+        const auto total = static_cast<uint64>(level.visible_quantity) + level.hidden_quantity;
+        const auto all   = quantity >= total;
+
+        // Replenished iceberg slices are appended to the queue, only the orders present on entry take part.
+        uint64   cumulative = 0;
+        Quantity allocated  = 0;
+        auto     handle     = level.orders.head;
+        for (auto count = level.orders.size; count > 0 && allocated < quantity; --count)
+        {
+            const auto next      = orders[handle].next;
+            const auto remaining = orders[handle].remaining_quantity;
+
+            cumulative += remaining;
+            const auto target = all ? allocated + remaining : static_cast<Quantity>(quantity * cumulative / total);
+            if (target > allocated)
+            {
+                fill(handle, target - allocated);
+                allocated = target;
+            }
+            handle = next;
+        }
+    }
+
+    //==============================================================================================
+    // class : LmmMatching
+    //==============================================================================================
+
+    constexpr LmmMatching::LmmMatching(const MatchingConfig& config) noexcept
+        : _lead_market_maker(config.lead_market_maker)
+        , _allocation(std::min(config.lmm_allocation, uint32(100)))
+    {}
+
+    template <typename Level, typename Fill>
+    constexpr auto LmmMatching::match(const OrderPool& orders, const Level& level, Quantity quantity, Fill&& fill) const -> void
+    {
+        auto reserved = static_cast<Quantity>(static_cast<uint64>(quantity) * _allocation / 100);
+        if (_lead_market_maker != invalid_account)
+        {
+            auto handle = level.orders.head;
+            for (auto count = level.orders.size; count > 0 && reserved > 0; --count)
+            {
+                const auto next = orders[handle].next;
+                if (orders.details(handle).account == _lead_market_maker)
+                {
+                    const auto filled = std::min(reserved, orders[handle].remaining_quantity);
+
+                    reserved -= filled;
+                    quantity -= filled;
+                    fill(handle, filled);
+                }
+                handle = next;
+            }
+        }
+
+        FifoMatching().match(orders, level, quantity, fill);
+    }
+}
@@ -5,6 +5,7 @@
 #include "order_book/order_type.hpp"
 #include "order_book/types.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 
@@ -12,7 +13,8 @@ namespace flob
 {
     constexpr auto invalid_price = std::numeric_limits<Price>::max();
 
-    using Clock     = std::chrono::high_resolution_clock;
+    // Wall clock, shared with the trading sessions so that expiries and closes use the same time base.
+    using Clock     = std::chrono::system_clock;
     using TimePoint = std::chrono::time_point<Clock>;
 
     class Order : public RefCounted<Order>
@@ -21,52 +23,158 @@ namespace flob
         Order(OrderType type, Side side, Price price, Quantity quantity) noexcept;
         Order(Side side, Quantity quantity) noexcept;
 
+        Order(OrderId id, OrderType type, Side side, Price price, Quantity quantity) noexcept;
+        Order(OrderId id, Side side, Quantity quantity) noexcept;
+
+        // Iceberg order, only `peak_quantity` is displayed at a time.
+        Order(OrderType type, Side side, Price price, Quantity quantity, Quantity peak_quantity) noexcept;
+        Order(OrderId id, OrderType type, Side side, Price price, Quantity quantity, Quantity peak_quantity) noexcept;
+
+        // Good till time order, expired by the book once its clock reaches `expiry`.
+        Order(Side side, Price price, Quantity quantity, TimePoint expiry) noexcept;
+        Order(OrderId id, Side side, Price price, Quantity quantity, TimePoint expiry) noexcept;
+
+        // A non-zero `peak_quantity` makes the order an iceberg. A valid `stop_price` makes it a stop order, held back
+        // until the last traded price reaches it: a stop-limit when `price` is valid, a stop (market) otherwise.
+        // `expiry` is only used by GTT orders.
+        Order(OrderType type, Side side, Price price, Quantity quantity, OrderFlags flags, Quantity peak_quantity = 0, Price stop_price = invalid_price, TimePoint expiry = {}) noexcept;
+        Order(OrderId id, OrderType type, Side side, Price price, Quantity quantity, OrderFlags flags, Quantity peak_quantity = 0, Price stop_price = invalid_price, TimePoint expiry = {}) noexcept;
+
         ~Order() noexcept = default;
 
     public:
         [[nodiscard]] constexpr auto id() const noexcept -> OrderId;
         [[nodiscard]] constexpr auto time_point() const noexcept -> TimePoint;
+        [[nodiscard]] constexpr auto expiry() const noexcept -> TimePoint;
         [[nodiscard]] constexpr auto price() const noexcept -> Price;
+        [[nodiscard]] constexpr auto stop_price() const noexcept -> Price;
         [[nodiscard]] constexpr auto remaining_quantity() const noexcept -> Quantity;
+        [[nodiscard]] constexpr auto reserve_quantity() const noexcept -> Quantity;
+        [[nodiscard]] constexpr auto visible_quantity() const noexcept -> Quantity;
+        [[nodiscard]] constexpr auto total_quantity() const noexcept -> Quantity;
+        [[nodiscard]] constexpr auto peak_quantity() const noexcept -> Quantity;
         [[nodiscard]] constexpr auto type() const noexcept -> OrderType;
         [[nodiscard]] constexpr auto side() const noexcept -> Side;
+        [[nodiscard]] constexpr auto flags() const noexcept -> OrderFlags;
+        [[nodiscard]] constexpr auto account() const noexcept -> AccountId;
 
         [[nodiscard]] constexpr auto is_market_order() const noexcept -> bool;
+        [[nodiscard]] constexpr auto is_iceberg() const noexcept -> bool;
+        [[nodiscard]] constexpr auto is_post_only() const noexcept -> bool;
+        [[nodiscard]] constexpr auto is_hidden() const noexcept -> bool;
+        [[nodiscard]] constexpr auto is_stop() const noexcept -> bool;
+
+        constexpr auto reprice(Price price) noexcept -> void;
+
+        // Owner of the order, invalid_account unless set before the order is sent to the book.
+        constexpr auto set_account(AccountId account) noexcept -> void;
 
+        // Turns a stop order into the market or limit order it was waiting to become.
+        constexpr auto activate() noexcept -> void;
+
+        // Fills only apply to the displayed quantity, an exhausted iceberg slice must be replenished.
         constexpr auto               fill(Quantity quantity) noexcept -> void;
+        constexpr auto               replenish() noexcept -> Quantity;
         [[nodiscard]] constexpr auto is_filled() const noexcept -> bool;
+        [[nodiscard]] constexpr auto needs_replenish() const noexcept -> bool;
 
     private:
-        OrderId   _id;
-        TimePoint _time_point;
-        Price     _price;
-        Quantity  _remaining_quantity;
-        OrderType _type;
-        Side      _side;
+        OrderId    _id;
+        TimePoint  _time_point;
+        TimePoint  _expiry;
+        Price      _price;
+        Price      _stop_price;
+        Quantity   _remaining_quantity;
+        Quantity   _reserve_quantity;
+        Quantity   _peak_quantity;
+        AccountId  _account;
+        OrderType  _type;
+        Side       _side;
+        OrderFlags _flags;
     };
 
+    static_assert(sizeof(Order) <= 64, "Order should fit in a single cache line");
+
     //==============================================================================================
     // class : Order
     //==============================================================================================
 
     inline Order::Order(OrderType type, Side side, Price price, Quantity quantity) noexcept
-        : _id(UUID())
+        : Order(UUID(), type, side, price, quantity)
+    {}
+
+    inline Order::Order(Side side, Quantity quantity) noexcept
+        : Order(UUID(), side, quantity)
+    {}
+
+    inline Order::Order(OrderId id, OrderType type, Side side, Price price, Quantity quantity) noexcept
+        : _id(id)
         , _time_point(Clock::now())
+        , _expiry()
         , _price(price)
+        , _stop_price(invalid_price)
         , _remaining_quantity(quantity)
+        , _reserve_quantity(0)
+        , _peak_quantity(0)
+        , _account(invalid_account)
         , _type(type)
         , _side(side)
+        , _flags(OrderFlags::None)
     {}
 
-    inline Order::Order(Side side, Quantity quantity) noexcept
-        : _id(UUID())
+    inline Order::Order(OrderId id, Side side, Quantity quantity) noexcept
+        : _id(id)
         , _time_point(Clock::now())
+        , _expiry()
         , _price(invalid_price)
+        , _stop_price(invalid_price)
         , _remaining_quantity(quantity)
+        , _reserve_quantity(0)
+        , _peak_quantity(0)
+        , _account(invalid_account)
         , _type(OrderType::None)
         , _side(side)
+        , _flags(OrderFlags::None)
+    {}
+
+    inline Order::Order(OrderType type, Side side, Price price, Quantity quantity, Quantity peak_quantity) noexcept
+        : Order(UUID(), type, side, price, quantity, OrderFlags::Iceberg, peak_quantity)
     {}
 
+    inline Order::Order(OrderId id, OrderType type, Side side, Price price, Quantity quantity, Quantity peak_quantity) noexcept
+        : Order(id, type, side, price, quantity, OrderFlags::Iceberg, peak_quantity)
+    {}
+
+    inline Order::Order(Side side, Price price, Quantity quantity, TimePoint expiry) noexcept
+        : Order(UUID(), side, price, quantity, expiry)
+    {}
+
+    inline Order::Order(OrderId id, Side side, Price price, Quantity quantity, TimePoint expiry) noexcept
+        : Order(id, OrderType::GTT, side, price, quantity, OrderFlags::None, 0, invalid_price, expiry)
+    {}
+
+    inline Order::Order(OrderType type, Side side, Price price, Quantity quantity, OrderFlags flags, Quantity peak_quantity, Price stop_price, TimePoint expiry) noexcept
+        : Order(UUID(), type, side, price, quantity, flags, peak_quantity, stop_price, expiry)
+    {}
+
+    inline Order::Order(OrderId id, OrderType type, Side side, Price price, Quantity quantity, OrderFlags flags, Quantity peak_quantity, Price stop_price, TimePoint expiry) noexcept
+        : _id(id)
+        , _time_point(Clock::now())
+        , _expiry(expiry)
+        , _price(price)
+        , _stop_price(stop_price)
+        , _remaining_quantity(peak_quantity > 0 ? std::min(quantity, peak_quantity) : quantity)
+        , _reserve_quantity(peak_quantity > 0 ? quantity - std::min(quantity, peak_quantity) : 0)
+        , _peak_quantity(peak_quantity)
+        , _account(invalid_account)
+        , _type(type)
+        , _side(side)
+        , _flags(peak_quantity > 0 ? flags | OrderFlags::Iceberg : flags)
+    {
+        ensure(!has_flag(_flags, OrderFlags::Iceberg) || peak_quantity > 0, "Iceberg peak quantity must be positive");
+        ensure(!has_flag(_flags, OrderFlags::Iceberg) || !has_flag(_flags, OrderFlags::Hidden), "An order cannot be both iceberg and hidden");
+    }
+
     constexpr auto Order::id() const noexcept -> OrderId
     {
         return _id;
@@ -77,16 +185,46 @@ namespace flob
         return _time_point;
     }
 
+    constexpr auto Order::expiry() const noexcept -> TimePoint
+    {
+        return _expiry;
+    }
+
     constexpr auto Order::price() const noexcept -> Price
     {
         return _price;
     }
 
+    constexpr auto Order::stop_price() const noexcept -> Price
+    {
+        return _stop_price;
+    }
+
     constexpr auto Order::remaining_quantity() const noexcept -> Quantity
     {
         return _remaining_quantity;
     }
 
+    constexpr auto Order::reserve_quantity() const noexcept -> Quantity
+    {
+        return _reserve_quantity;
+    }
+
+    constexpr auto Order::visible_quantity() const noexcept -> Quantity
+    {
+        return is_hidden() ? 0 : _remaining_quantity;
+    }
+
+    constexpr auto Order::total_quantity() const noexcept -> Quantity
+    {
+        return _remaining_quantity + _reserve_quantity;
+    }
+
+    constexpr auto Order::peak_quantity() const noexcept -> Quantity
+    {
+        return _peak_quantity;
+    }
+
     constexpr auto Order::type() const noexcept -> OrderType
     {
         return _type;
@@ -97,19 +235,77 @@ namespace flob
         return _side;
     }
 
+    constexpr auto Order::flags() const noexcept -> OrderFlags
+    {
+        return _flags;
+    }
+
+    constexpr auto Order::account() const noexcept -> AccountId
+    {
+        return _account;
+    }
+
     constexpr auto Order::is_market_order() const noexcept -> bool
     {
         return _price == invalid_price;
     }
 
+    constexpr auto Order::is_iceberg() const noexcept -> bool
+    {
+        return has_flag(_flags, OrderFlags::Iceberg);
+    }
+
+    constexpr auto Order::is_post_only() const noexcept -> bool
+    {
+        return has_flag(_flags, OrderFlags::PostOnly);
+    }
+
+    constexpr auto Order::is_hidden() const noexcept -> bool
+    {
+        return has_flag(_flags, OrderFlags::Hidden);
+    }
+
+    constexpr auto Order::is_stop() const noexcept -> bool
+    {
+        return _stop_price != invalid_price;
+    }
+
+    constexpr auto Order::reprice(Price price) noexcept -> void
+    {
+        _price = price;
+    }
+
+    constexpr auto Order::set_account(AccountId account) noexcept -> void
+    {
+        _account = account;
+    }
+
+    constexpr auto Order::activate() noexcept -> void
+    {
+        _stop_price = invalid_price;
+    }
+
     constexpr auto Order::fill(Quantity quantity) noexcept -> void
     {
         ensure(quantity <= _remaining_quantity, "Quantity exceeds remaining quantity");
         _remaining_quantity -= quantity;
     }
 
+    constexpr auto Order::replenish() noexcept -> Quantity
+    {
+        const auto slice = std::min(_peak_quantity, _reserve_quantity);
+        _remaining_quantity += slice;
+        _reserve_quantity -= slice;
+        return slice;
+    }
+
     constexpr auto Order::is_filled() const noexcept -> bool
     {
-        return _remaining_quantity == 0;
+        return _remaining_quantity == 0 && _reserve_quantity == 0;
+    }
+
+    constexpr auto Order::needs_replenish() const noexcept -> bool
+    {
+        return _remaining_quantity == 0 && _reserve_quantity != 0;
     }
 }
@@ -1,19 +1,33 @@
 #pragma once
 
-#include "containers/hash_map.hpp"
+#include "analytics/feature_stream.hpp"
+#include "analytics/trade_tape.hpp"
 #include "containers/map.hpp"
+#include "containers/small_vector.hpp"
+#include "containers/timer_wheel.hpp"
 #include "containers/vector.hpp"
+#include "market_data/consolidated_book.hpp"
+#include "market_data/depth_view.hpp"
+#include "market_data/shared_book.hpp"
+#include "memory/node_pool.hpp"
 #include "memory/ref.hpp"
+#include "order_book/command.hpp"
+#include "order_book/depth_index.hpp"
+#include "order_book/depth_levels.hpp"
+#include "order_book/matching_policy.hpp"
 #include "order_book/order.hpp"
+#include "order_book/order_pool.hpp"
 #include "order_book/session.hpp"
 #include "order_book/trade.hpp"
+#include "risk/pnl_tracker.hpp"
+#include "risk/risk_manager.hpp"
 
-#include <deque>
+#include <chrono>
+#include <memory>
 
 namespace flob
 {
-    using OrderRef  = Ref<Order>;
-    using OrderRefs = std::deque<OrderRef>;
+    using OrderRef = Ref<Order>;
 
     struct OrderBookLevelInfos
     {
@@ -21,58 +35,316 @@ namespace flob
         Quantity quantity;
     };
 
+    using OrderBookLevelsInfos = SmallVector<OrderBookLevelInfos, 64>;
+
     struct OrderBookInfos
     {
-        Vector<OrderBookLevelInfos> bids;
-        Vector<OrderBookLevelInfos> asks;
+        OrderBookLevelsInfos bids;
+        OrderBookLevelsInfos asks;
+    };
+
+    enum class PostOnlyPolicy : uint8
+    {
+        Reject,   // Drop post-only orders that would cross
+        Reprice,  // Slide them one tick behind the best opposite price
+    };
+
+    enum class TradingPhase : uint8
+    {
+        Continuous,  // Orders match on arrival
+        Auction,     // Call period, orders accumulate until the book is uncrossed
+    };
+
+    // Single price at which a call period executes, and the volume it executes.
+    struct AuctionEquilibrium
+    {
+        Price  price;   // invalid_price when nothing crosses
+        uint64 volume;
     };
 
     struct OrderBookConfig
     {
-        Session session;
+        Session        session;
+        PostOnlyPolicy post_only_policy = PostOnlyPolicy::Reject;
+        MatchingConfig matching;
+        TradingPhase   initial_phase = TradingPhase::Continuous;
+        RiskManager*   risk          = nullptr;  // Optional pre-trade checks, must outlive the book
+        PnlTracker*    pnl           = nullptr;  // Optional fill consumer, must outlive the book
+        FeatureStream* features      = nullptr;  // Optional top of book consumer, must outlive the book
+        TradeTape*     tape          = nullptr;  // Optional trade recorder, must outlive the book
+        BookPublisher* publisher     = nullptr;  // Optional shared memory top of book and depth, must outlive the book
+        DepthView*     view          = nullptr;  // Optional depth snapshots for other threads, must outlive the book
+
+        // Optional multi-venue view the book feeds as venue `venue`, which must be below its number of venues. Must
+        // outlive the book.
+        ConsolidatedBook* consolidated = nullptr;
+        usize             venue        = 0;
+
+        // Price range covered by the depth index, which is disabled unless depth_max_price > depth_min_price.
+        Price depth_min_price = 0;
+        Price depth_max_price = 0;
+
+        // Frequent batch auctions: when positive, the book stays in call periods and uncrosses every interval of its
+        // clock instead of trading continuously.
+        std::chrono::nanoseconds batch_interval = std::chrono::nanoseconds::zero();
+
+        // The book clock follows Clock::now() on every operation unless it is driven by advance_time(), e.g. when
+        // replaying historical flow. Orders expire at the first timer tick at or after their expiry.
+        bool                     manual_clock = false;
+        TimePoint                start_time   = Clock::now();
+        std::chrono::nanoseconds timer_tick   = std::chrono::milliseconds(1);
+
+        // Preallocated orders, with their expiry timers, and price levels per side. A book that stays within them never
+        // allocates, provided trades and infos are read into reused buffers. Beyond them it grows as usual. The pages
+        // back the preallocated memory and the level nodes, e.g. huge pages and a pre-fault for large books.
+        usize      order_capacity = 0;
+        usize      level_capacity = 0;
+        PageConfig pages;
     };
 
-    class OrderBook
+    // The matching policy is a template parameter so that the matching loop is specialized for each of them. The
+    // supported policies are explicitly instantiated in order_book.cpp.
+    template <typename MatchingPolicy>
+    class BasicOrderBook
     {
     public:
-        explicit OrderBook(const OrderBookConfig& config);
+        explicit BasicOrderBook(const OrderBookConfig& config);
 
     public:
         [[nodiscard]] constexpr auto size() const noexcept -> usize;
 
+        // invalid_price when the side is empty.
+        [[nodiscard]] auto best_bid() const noexcept -> Price;
+        [[nodiscard]] auto best_ask() const noexcept -> Price;
+
+        // Price of the last trade, invalid_price before the first one.
+        [[nodiscard]] constexpr auto last_price() const noexcept -> Price;
+
+        // Marks for open positions, NaN when a side is empty. The microprice weighs each best price by the displayed
+        // quantity on the other side.
+        [[nodiscard]] auto mid_price() const noexcept -> float64;
+        [[nodiscard]] auto micro_price() const noexcept -> float64;
+
+        // Best prices and their displayed quantities.
+        [[nodiscard]] auto top() const noexcept -> TopOfBook;
+
+        [[nodiscard]] constexpr auto now() const noexcept -> TimePoint;
+        [[nodiscard]] constexpr auto phase() const noexcept -> TradingPhase;
+
+        // Indicative uncross of the current call period, computed from the level totals without touching orders.
+        [[nodiscard]] auto equilibrium() const noexcept -> AuctionEquilibrium;
+
+        // Only displayed quantity is reported, hidden orders and iceberg reserves are left out. Matching thread only,
+        // other threads read the DepthView of the config.
         [[nodiscard]] auto infos() const -> OrderBookInfos;
+        auto               infos(OrderBookInfos& infos) const -> void;
 
-        auto add_order(const OrderRef& order) -> Vector<Trade>;
+        // Displayed levels of a side in contiguous arrays, for vectorized depth queries. `count` caps the number of
+        // levels when positive.
+        auto depth_levels(Side side, DepthLevels& levels, usize count = 0) const -> void;
 
-    private:
-        auto cancel_order(OrderId order_id) -> void;
-        auto cancel_orders(OrderType order_type) -> void;
+        // Execution cost and depth queries over the displayed quantity, O(log range) and allocation free.
+        [[nodiscard]] constexpr auto depth() const noexcept -> const DepthIndex&;
+
+        // Operations that trade have an overload appending the trades to a buffer of the caller instead of returning
+        // them, so that a caller reusing the buffer never allocates for them.
+
+        // The book keeps its own compact copy of the order, later fills are reported through the trades only. The
+        // buffer overloads also tell whether the book took the order, stop orders being taken once parked.
+        auto add_order(const OrderRef& order) -> Trades;
+        auto add_order(const Order& order, Trades& trades) -> OrderStatus;
+        auto cancel_order(OrderId order_id) -> bool;
+
+        // Replaces the price and quantity of a resting order, the order keeps its id but loses its time priority. A
+        // replacement that is not taken leaves the order cancelled.
+        auto modify_order(OrderId order_id, Price price, Quantity quantity) -> Trades;
+        auto modify_order(OrderId order_id, Price price, Quantity quantity, Trades& trades) -> OrderStatus;
+
+        auto apply(const OrderCommand& command) -> Trades;
+        auto apply(const OrderCommand& command, Trades& trades) -> OrderStatus;
+
+        // Moves the book clock forward and expires the GTT and GFD orders that came due, earliest first. The cost only
+        // depends on the number of expiring orders. Going back in time is ignored. Returns the trades of the batch
+        // auction that came due, if any.
+        auto advance_time(TimePoint now) -> Trades;
+        auto advance_time(TimePoint now, Trades& trades) -> void;
 
-        auto match_orders() -> Vector<Trade>;
+        // Opens a call period, e.g. for an opening or closing cross. Limit orders rest without matching, IOC and market
+        // orders are rejected since there is nothing to execute against yet.
+        auto start_auction() -> void;
 
-        auto cancel_gfd_if_needed() -> void;
+        // Executes the call period at its equilibrium price, then resumes continuous trading unless the book runs
+        // batch auctions. Orders are only touched to fill them.
+        auto uncross() -> Trades;
+        auto uncross(Trades& trades) -> void;
 
-        struct OrderEntry
+        // Snapshots the depth into the view now instead of at the next refresh, e.g. before the book goes idle.
+        auto refresh_view() -> void;
+
+    private:
+        struct Level
+        {
+            OrderQueue orders;
+            Quantity   visible_quantity;
+            Quantity   hidden_quantity;   // Hidden orders, matchable but not displayed
+            Quantity   reserve_quantity;  // Iceberg reserves, only matchable once replenished
+        };
+
+        struct AuctionFill
         {
-            OrderRef            order;
-            OrderRefs::iterator location;
+            OrderId  id;
+            Quantity quantity;
         };
 
+        // Levels and stop prices come and go with the flow, their map nodes are recycled through the node pool.
+        template <typename Compare>
+        using LevelMap = Map<Price, Level, Compare, PoolAllocator<std::pair<const Price, Level>>>;
+
+        template <typename Compare>
+        using StopMap = Map<Price, OrderQueue, Compare, PoolAllocator<std::pair<const Price, OrderQueue>>>;
+
     private:
-        Map<Price, OrderRefs, std::greater<Price>> _bids;
-        Map<Price, OrderRefs, std::less<Price>>    _asks;
-        HashMap<OrderId, OrderEntry>               _orders;
+        auto submit_order(const Order& order, Trades& trades) -> OrderStatus;
+        auto place_order(OrderHandle handle, Trades& trades) -> OrderStatus;
+        auto reject_order(OrderHandle handle) -> void;
+        auto accept_post_only(RestingOrder& order) -> bool;
+        auto remove_order(OrderHandle handle) -> void;
+        auto erase_entry(OrderHandle handle) -> void;
+        auto withdraw_order(OrderId order_id) -> bool;
+
+        // What the order can trade for, as the risk check sees it: its price times its quantity, the cost of sweeping
+        // the other side for a market order.
+        [[nodiscard]] auto notional(const Order& order) const -> uint64;
+
+        auto park_stop_order(OrderHandle handle) -> void;
+        auto trigger_stop_orders(Trades& trades) -> void;
+        auto pop_triggered_stop_order() -> OrderHandle;
 
-        Session _session;
-        bool    _gfd_expired_today;
+        auto match_orders(Side aggressor, Trades& trades) -> void;
+
+        template <typename Incoming, typename Resting>
+        auto match_levels(Incoming& incoming, Resting& resting, Side aggressor, Trades& trades) -> void;
+
+        auto fill_resting_order(Level& level, OrderHandle handle, Price price, Quantity quantity, Liquidity liquidity) -> void;
+
+        template <typename Levels>
+        auto allocate_auction(Levels& levels, Price price, uint64 volume, Vector<AuctionFill>& fills) -> void;
+
+        // advance_time() without the publishing, for the operations that move the clock on their way and publish once
+        // they are done.
+        auto advance_clock(TimePoint now, Trades& trades) -> void;
+
+        auto schedule_expiry(OrderHandle handle) -> TimerHandle;
+        auto expire_order(OrderHandle handle) -> void;
+        auto to_tick(TimePoint time_point) const noexcept -> uint64;
+
+        // Every change of displayed quantity goes through display(), which keeps the depth index in step, records the
+        // best touched price of the side and feeds the consolidated view.
+        auto display(Side side, Price price, int64 quantity) -> void;
+
+        // Best price of the side whose displayed quantity changed since the last clear_touched(), invalid_price when
+        // none did. Tracked over the whole book, so that publish_depth() can skip the operations that did not reach
+        // the levels it shows.
+        [[nodiscard]] constexpr auto touched(Side side) const noexcept -> Price;
+        constexpr auto               clear_touched() noexcept -> void;
+
+        // Reports the top of the book once a public operation is done, intermediate states are never sampled.
+        auto publish_features() -> void;
+        auto publish_depth() -> void;
+        auto publish_view() -> void;
+
+    private:
+        std::unique_ptr<NodePool>     _nodes;  // Heap allocated so that the maps can keep pointing to it when the book moves
+        LevelMap<std::greater<Price>> _bids;
+        LevelMap<std::less<Price>>    _asks;
+        OrderPool                     _orders;  // Resting and pending stop orders
+
+        // Pending stop orders, sorted so that the next one to trigger is always first.
+        StopMap<std::less<Price>>    _buy_stops;
+        StopMap<std::greater<Price>> _sell_stops;
+        Price                        _last_price;
+
+        // Book clock, GTT and GFD expiries are keyed by timer tick.
+        TimePoint                _now;
+        std::chrono::nanoseconds _timer_tick;
+        bool                     _manual_clock;
+        TimerWheel<OrderHandle>  _timers;
+
+        TradingPhase             _phase;
+        TimePoint::duration      _batch_interval;
+        TimePoint                _next_batch;
+        Vector<AuctionFill>      _bid_fills;  // Scratch buffers of uncross()
+        Vector<AuctionFill>      _ask_fills;
+
+        Session        _session;
+        PostOnlyPolicy _post_only_policy;
+        MatchingPolicy _matching;
+        RiskManager*   _risk;
+        PnlTracker*    _pnl;
+        FeatureStream* _features;
+        TradeTape*     _tape;
+        BookPublisher* _publisher;
+        DepthView*     _view;
+        DepthIndex     _depth;
+        Price          _touched_bid;  // See touched()
+        Price          _touched_ask;
+
+        ConsolidatedBook* _consolidated;
+        usize             _venue;
     };
 
+    using OrderBook        = BasicOrderBook<FifoMatching>;
+    using ProRataOrderBook = BasicOrderBook<ProRataMatching>;
+    using LmmOrderBook     = BasicOrderBook<LmmMatching>;
+
+    extern template class BasicOrderBook<FifoMatching>;
+    extern template class BasicOrderBook<ProRataMatching>;
+    extern template class BasicOrderBook<LmmMatching>;
+
     //==============================================================================================
-    // class : OrderBook
+    // class : BasicOrderBook
     //==============================================================================================
 
-    constexpr auto OrderBook::size() const noexcept -> usize
+    template <typename MatchingPolicy>
+    constexpr auto BasicOrderBook<MatchingPolicy>::size() const noexcept -> usize
     {
         return _orders.size();
     }
+
+    template <typename MatchingPolicy>
+    constexpr auto BasicOrderBook<MatchingPolicy>::last_price() const noexcept -> Price
+    {
+        return _last_price;
+    }
+
+    template <typename MatchingPolicy>
+    constexpr auto BasicOrderBook<MatchingPolicy>::now() const noexcept -> TimePoint
+    {
+        return _now;
+    }
+
+    template <typename MatchingPolicy>
+    constexpr auto BasicOrderBook<MatchingPolicy>::depth() const noexcept -> const DepthIndex&
+    {
+        return _depth;
+    }
+
+    template <typename MatchingPolicy>
+    constexpr auto BasicOrderBook<MatchingPolicy>::phase() const noexcept -> TradingPhase
+    {
+        return _phase;
+    }
+
+    template <typename MatchingPolicy>
+    constexpr auto BasicOrderBook<MatchingPolicy>::touched(Side side) const noexcept -> Price
+    {
+        return side == Side::Buy ? _touched_bid : _touched_ask;
+    }
+
+    template <typename MatchingPolicy>
+    constexpr auto BasicOrderBook<MatchingPolicy>::clear_touched() noexcept -> void
+    {
+        _touched_bid = invalid_price;
+        _touched_ask = invalid_price;
+    }
 }
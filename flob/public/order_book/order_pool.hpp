@@ -0,0 +1,242 @@
+#pragma once
+
+#include "containers/timer_wheel.hpp"
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "debug/ensure.hpp"
+#include "memory/pages.hpp"
+#include "order_book/order.hpp"
+#include "order_book/order_type.hpp"
+#include "order_book/types.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace flob
+{
+    using OrderHandle = uint32;
+
+    constexpr auto invalid_handle = std::numeric_limits<OrderHandle>::max();
+
+    // What matching reads and writes, packed so that walking a queue streams through 24 byte records.
+    struct RestingOrder
+    {
+        Price       price;
+        Quantity    remaining_quantity;  // Displayed slice of an iceberg
+        Quantity    reserve_quantity;    // Iceberg reserve
+        OrderHandle prev;                // Links in the queue of a level or of a stop price
+        OrderHandle next;
+        Side        side;
+        OrderFlags  flags;
+
+        [[nodiscard]] constexpr auto visible_quantity() const noexcept -> Quantity;
+        [[nodiscard]] constexpr auto total_quantity() const noexcept -> Quantity;
+
+        [[nodiscard]] constexpr auto is_market_order() const noexcept -> bool;
+        [[nodiscard]] constexpr auto is_post_only() const noexcept -> bool;
+        [[nodiscard]] constexpr auto is_hidden() const noexcept -> bool;
+
+        constexpr auto               fill(Quantity quantity) noexcept -> void;
+        constexpr auto               replenish(Quantity peak_quantity) noexcept -> Quantity;
+        [[nodiscard]] constexpr auto is_filled() const noexcept -> bool;
+        [[nodiscard]] constexpr auto needs_replenish() const noexcept -> bool;
+    };
+
+    // Only read when an order enters or leaves the book, is modified, trades or refills its slice.
+    struct OrderDetails
+    {
+        OrderId     id;
+        TimePoint   expiry;
+        Price       stop_price;
+        Quantity    peak_quantity;
+        AccountId   account;
+        TimerHandle timer;  // Pending expiry, invalid_timer when the order never expires
+        OrderType   type;
+    };
+
+    static_assert(sizeof(RestingOrder) == 24, "Hot order fields should stay packed");
+    static_assert(sizeof(OrderDetails) <= 40, "Cold order fields should stay compact");
+
+    // FIFO of pooled orders, linked through their hot records.
+    struct OrderQueue
+    {
+        OrderHandle head = invalid_handle;
+        OrderHandle tail = invalid_handle;
+        uint32      size = 0;
+
+        [[nodiscard]] constexpr auto empty() const noexcept -> bool;
+    };
+
+    // Orders of a book, hot and cold fields in two parallel arrays addressed by 32-bit handles. Freed slots are reused
+    // first. Orders are found by id through an open addressing table of handles, the id itself is only stored once,
+    // in the cold array.
+    class OrderPool
+    {
+    public:
+        OrderPool() noexcept;
+
+    public:
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+
+        // Bytes held by the arrays and the id table.
+        [[nodiscard]] constexpr auto memory_usage() const noexcept -> usize;
+
+        // The reserved arrays are backed as the page config asks, growth past them is not.
+        auto reserve(usize capacity, const PageConfig& pages = {}) -> void;
+
+        // The id must not be in the pool already.
+        auto insert(const Order& order) -> OrderHandle;
+        auto erase(OrderHandle handle) noexcept -> void;
+
+        // invalid_handle when there is no such order.
+        [[nodiscard]] auto find(OrderId id) const noexcept -> OrderHandle;
+
+        constexpr auto operator[](OrderHandle handle) noexcept -> RestingOrder&;
+        constexpr auto operator[](OrderHandle handle) const noexcept -> const RestingOrder&;
+
+        constexpr auto               details(OrderHandle handle) noexcept -> OrderDetails&;
+        [[nodiscard]] constexpr auto details(OrderHandle handle) const noexcept -> const OrderDetails&;
+
+        //--------------------------------------------------------------------------------------------------------------
+        // Queues
+        //--------------------------------------------------------------------------------------------------------------
+
+        constexpr auto push_back(OrderQueue& queue, OrderHandle handle) noexcept -> void;
+        constexpr auto unlink(OrderQueue& queue, OrderHandle handle) noexcept -> void;
+
+    private:
+        [[nodiscard]] constexpr auto home(OrderId id) const noexcept -> usize;
+
+        auto rehash(usize capacity, const PageConfig& pages = {}) -> void;
+
+    private:
+        Vector<RestingOrder> _orders;
+        Vector<OrderDetails> _details;
+        OrderHandle          _free;  // Freed slots, chained through RestingOrder::next
+        usize                _size;
+
+        Vector<OrderHandle> _index;  // Linear probing, at most half full
+        uint32              _index_shift;
+    };
+
+    //==============================================================================================
+    // struct : RestingOrder
+    //==============================================================================================
+
+    constexpr auto RestingOrder::visible_quantity() const noexcept -> Quantity
+    {
+        return is_hidden() ? 0 : remaining_quantity;
+    }
+
+    constexpr auto RestingOrder::total_quantity() const noexcept -> Quantity
+    {
+        return remaining_quantity + reserve_quantity;
+    }
+
+    constexpr auto RestingOrder::is_market_order() const noexcept -> bool
+    {
+        return price == invalid_price;
+    }
+
+    constexpr auto RestingOrder::is_post_only() const noexcept -> bool
+    {
+        return has_flag(flags, OrderFlags::PostOnly);
+    }
+
+    constexpr auto RestingOrder::is_hidden() const noexcept -> bool
+    {
+        return has_flag(flags, OrderFlags::Hidden);
+    }
+
+    constexpr auto RestingOrder::fill(Quantity quantity) noexcept -> void
+    {
+        ensure(quantity <= remaining_quantity, "Quantity exceeds remaining quantity");
+        remaining_quantity -= quantity;
+    }
+
+    constexpr auto RestingOrder::replenish(Quantity peak_quantity) noexcept -> Quantity
+    {
+        const auto slice = std::min(peak_quantity, reserve_quantity);
+        remaining_quantity += slice;
+        reserve_quantity -= slice;
+        return slice;
+    }
+
+    constexpr auto RestingOrder::is_filled() const noexcept -> bool
+    {
+        return remaining_quantity == 0 && reserve_quantity == 0;
+    }
+
+    constexpr auto RestingOrder::needs_replenish() const noexcept -> bool
+    {
+        return remaining_quantity == 0 && reserve_quantity != 0;
+    }
+
+    //==============================================================================================
+    // struct : OrderQueue
+    //==============================================================================================
+
+    constexpr auto OrderQueue::empty() const noexcept -> bool
+    {
+        return size == 0;
+    }
+
+    //==============================================================================================
+    // class : OrderPool
+    //==============================================================================================
+
+    constexpr auto OrderPool::size() const noexcept -> usize
+    {
+        return _size;
+    }
+
+    constexpr auto OrderPool::memory_usage() const noexcept -> usize
+    {
+        return _orders.capacity() * sizeof(RestingOrder) + _details.capacity() * sizeof(OrderDetails) + _index.capacity() * sizeof(OrderHandle);
+    }
+
+    constexpr auto OrderPool::operator[](OrderHandle handle) noexcept -> RestingOrder&
+    {
+        return _orders[handle];
+    }
+
+    constexpr auto OrderPool::operator[](OrderHandle handle) const noexcept -> const RestingOrder&
+    {
+        return _orders[handle];
+    }
+
+    constexpr auto OrderPool::details(OrderHandle handle) noexcept -> OrderDetails&
+    {
+        return _details[handle];
+    }
+
+    constexpr auto OrderPool::details(OrderHandle handle) const noexcept -> const OrderDetails&
+    {
+        return _details[handle];
+    }
+
+    constexpr auto OrderPool::push_back(OrderQueue& queue, OrderHandle handle) noexcept -> void
+    {
+        auto& order = _orders[handle];
+        order.prev  = queue.tail;
+        order.next  = invalid_handle;
+
+        (queue.tail == invalid_handle ? queue.head : _orders[queue.tail].next) = handle;
+        queue.tail = handle;
+        ++queue.size;
+    }
+
+    constexpr auto OrderPool::unlink(OrderQueue& queue, OrderHandle handle) noexcept -> void
+    {
+        const auto& order = _orders[handle];
+        (order.prev == invalid_handle ? queue.head : _orders[order.prev].next) = order.next;
+        (order.next == invalid_handle ? queue.tail : _orders[order.next].prev) = order.prev;
+        --queue.size;
+    }
+
+    constexpr auto OrderPool::home(OrderId id) const noexcept -> usize
+    {
+        // Fibonacci hashing, spreads sequential ids as well as random ones.
+        return static_cast<usize>((static_cast<uint64>(id) * 0x9E37'79B9'7F4A'7C15ull) >> _index_shift);
+    }
+}
@@ -17,5 +17,30 @@ namespace flob
         IOC,  // Immediate Or Cancel
         GFD,  // Good For Day
         FOK,  // Fill Or Kill
+        GTT,  // Good Till Time
     };
+
+    // Execution attributes, orthogonal to the time in force.
+    enum class OrderFlags : uint8
+    {
+        None     = 0,
+        Iceberg  = 1 << 0,  // Only a peak is displayed, the hidden reserve refills it
+        PostOnly = 1 << 1,  // Never takes liquidity, rejected or repriced when it would cross
+        Hidden   = 1 << 2,  // Rests and matches but is never displayed
+    };
+
+    constexpr auto operator|(OrderFlags lhs, OrderFlags rhs) noexcept -> OrderFlags
+    {
+        return static_cast<OrderFlags>(static_cast<uint8>(lhs) | static_cast<uint8>(rhs));
+    }
+
+    constexpr auto operator&(OrderFlags lhs, OrderFlags rhs) noexcept -> OrderFlags
+    {
+        return static_cast<OrderFlags>(static_cast<uint8>(lhs) & static_cast<uint8>(rhs));
+    }
+
+    constexpr auto has_flag(OrderFlags flags, OrderFlags flag) noexcept -> bool
+    {
+        return (flags & flag) != OrderFlags::None;
+    }
 }
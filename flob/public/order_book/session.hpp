@@ -15,6 +15,9 @@ namespace flob
 
         [[nodiscard]] auto is_open(TimePoint now = Clock::now()) const noexcept -> bool;
         [[nodiscard]] auto is_close(TimePoint now = Clock::now()) const noexcept -> bool;
+
+        // First close strictly after `now`, today's or tomorrow's.
+        [[nodiscard]] auto next_close(TimePoint now = Clock::now()) const noexcept -> TimePoint;
     };
 
     constexpr Session new_york_session = {
@@ -53,4 +56,12 @@ namespace flob
 
         return tod < open_time || tod >= close_time;
     }
+
+    inline auto Session::next_close(TimePoint now) const noexcept -> TimePoint
+    {
+        using namespace std::chrono;
+
+        const auto close_time = floor<days>(now) + close.hours() + close.minutes();
+        return now < close_time ? close_time : close_time + days(1);
+    }
 }
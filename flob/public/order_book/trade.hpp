@@ -1,11 +1,18 @@
 #pragma once
 
+#include "containers/small_vector.hpp"
 #include "order_book/types.hpp"
 
 #include <format>
 
 namespace flob
 {
+    enum class Liquidity : uint8
+    {
+        Maker,  // The filled order was resting
+        Taker,  // The filled order crossed the spread, or executed in an auction
+    };
+
     struct Trade
     {
         OrderId  bid_id;
@@ -14,6 +21,9 @@ namespace flob
         Price    ask_price;
         Quantity quantity;
     };
+
+    // Most orders fill against a handful of resting orders, so the trades of one order fit inline.
+    using Trades = SmallVector<Trade, 4>;
 }
 
 template <>
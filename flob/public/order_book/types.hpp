@@ -3,9 +3,14 @@
 #include "core_types.hpp"
 #include "misc/uuid.hpp"
 
+#include <limits>
+
 namespace flob
 {
-    using Price    = uint32;
-    using Quantity = uint32;
-    using OrderId  = UUID;
+    using Price     = uint32;
+    using Quantity  = uint32;
+    using OrderId   = UUID;
+    using AccountId = uint32;
+
+    constexpr auto invalid_account = std::numeric_limits<AccountId>::max();
 }
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "misc/random.hpp"
+#include "order_book/command.hpp"
+
+namespace flob
+{
+    using CommandBuffer = Vector<OrderCommand>;
+
+    // Relative weights of each kind of command, they do not need to sum to 1.
+    struct OrderMix
+    {
+        float64 add    = 0.10;
+        float64 cancel = 0.09;
+        float64 modify = 0.78;
+        float64 ioc    = 0.02;
+        float64 market = 0.01;
+    };
+
+    // Self-exciting arrivals: intensity(t) = baseline_rate + sum(excitation * decay * exp(-decay * (t - t_i))).
+    // `excitation` is the branching ratio and must stay below 1 for the process to be stationary.
+    struct HawkesConfig
+    {
+        float64 baseline_rate = 200'000.0;  // Events per second
+        float64 excitation    = 0.7;
+        float64 decay         = 50'000.0;   // Per second
+    };
+
+    struct WorkloadConfig
+    {
+        uint64       seed = 42;
+        OrderMix     mix;
+        HawkesConfig arrivals;
+
+        Price    mid_price       = 10'000;  // e.g. $100.00 in cents
+        float64  mid_move_rate   = 0.01;    // Probability that the reference mid moves by one tick per command
+        float64  distance_decay  = 0.15;    // Geometric parameter of the distance, in ticks, from the mid
+        uint32   max_distance    = 250;
+        Quantity min_qty         = 1;
+        Quantity max_qty         = 100;
+        usize    max_live_orders = 10'000;   // Steady state depth, adds turn into cancels above it
+        float64  iceberg_rate    = 0.0;     // Share of passive adds sent as icebergs
+        uint32   iceberg_slices  = 4;       // Number of displayed slices of an iceberg
+    };
+
+    // Reproducible synthetic order flow. Arrivals follow a Hawkes process, limit prices are drawn at a geometrically
+    // distributed distance from a randomly walking mid, and cancels/modifies target orders the generator added earlier.
+    // The generator cannot see fills, so some cancels and modifies target orders that are already gone, like in
+    // real flow.
+    class WorkloadGenerator
+    {
+    public:
+        explicit WorkloadGenerator(const WorkloadConfig& config = {});
+
+    public:
+        auto next() -> OrderCommand;
+
+        // Pre-generates `count` commands so that benchmarks only measure the book.
+        auto generate(usize count) -> CommandBuffer;
+        auto generate(CommandBuffer& buffer, usize count) -> void;
+
+    private:
+        auto next_timestamp() -> uint64;
+        auto next_quantity() -> Quantity;
+        auto next_limit_price(Side side) -> Price;
+
+        auto add_limit_order(uint64 timestamp, Side side) -> OrderCommand;
+        auto cancel_live_order(uint64 timestamp) -> OrderCommand;
+
+        struct LiveOrder
+        {
+            OrderId id;
+            Side    side;
+        };
+
+    private:
+        WorkloadConfig _config;
+        Random         _random;
+
+        Vector<LiveOrder> _live_orders;
+        uint64            _next_id;
+        Price             _mid_price;
+
+        float64 _time;        // Seconds
+        float64 _excitation;  // Self-excited part of the intensity at `_time`
+    };
+}
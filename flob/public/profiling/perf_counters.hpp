@@ -0,0 +1,115 @@
+#pragma once
+
+#include "core_types.hpp"
+
+#include <limits>
+#include <string_view>
+
+namespace flob
+{
+    enum class PerfEvent : uint8
+    {
+        Cycles,
+        Instructions,
+        L1DataMisses,  // L1 data cache read misses
+        LlcMisses,     // Last level cache misses
+        BranchMisses,
+        DtlbMisses,    // Data TLB read misses
+        PageFaults,    // Software event, counted even without a PMU
+        Count,
+    };
+
+    constexpr usize perf_event_count = static_cast<usize>(PerfEvent::Count);
+
+    [[nodiscard]] constexpr auto to_string(PerfEvent event) noexcept -> std::string_view;
+
+    // Counter values over one measured interval. Events the machine or the kernel does not expose are missing, and
+    // read as 0.
+    struct PerfSample
+    {
+        uint64 values[perf_event_count] = {};
+        uint32 available                = 0;  // Bit per event
+
+        [[nodiscard]] constexpr auto has(PerfEvent event) const noexcept -> bool;
+        [[nodiscard]] constexpr auto operator[](PerfEvent event) const noexcept -> uint64;
+
+        // Value per operation, NaN when the event is missing.
+        [[nodiscard]] constexpr auto per(PerfEvent event, uint64 operations) const noexcept -> float64;
+    };
+
+    // Hardware counters and page faults of the calling thread through Linux perf_event_open, user space only so that
+    // it works with the default perf_event_paranoid level. Each event is opened on its own, so a machine without a PMU
+    // event, a virtual machine or a container that blocks the syscall only loses the events it cannot count. When the
+    // kernel multiplexes the events over fewer hardware counters, values are scaled by the share of time they ran.
+    //
+    // Elsewhere nothing is counted and every sample is empty. Move only.
+    class PerfCounters
+    {
+    public:
+        PerfCounters() noexcept;
+        ~PerfCounters() noexcept;
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters(PerfCounters&& other) noexcept;
+
+        auto operator=(const PerfCounters&) -> PerfCounters& = delete;
+        auto operator=(PerfCounters&& other) noexcept -> PerfCounters&;
+
+    public:
+        // Whether at least one event is counted.
+        [[nodiscard]] auto available() const noexcept -> bool;
+        [[nodiscard]] auto has(PerfEvent event) const noexcept -> bool;
+
+        // Resets and starts every event, then stops them and reads what they counted in between.
+        auto start() noexcept -> void;
+        auto stop() noexcept -> PerfSample;
+
+    private:
+        auto close() noexcept -> void;
+
+    private:
+        int32 _fds[perf_event_count];
+    };
+
+    //==============================================================================================
+    // enum : PerfEvent
+    //==============================================================================================
+
+    constexpr auto to_string(PerfEvent event) noexcept -> std::string_view
+    {
+        switch (event)
+        {
+            case PerfEvent::Cycles:       return "cycles";
+            case PerfEvent::Instructions: return "instructions";
+            case PerfEvent::L1DataMisses: return "L1d misses";
+            case PerfEvent::LlcMisses:    return "LLC misses";
+            case PerfEvent::BranchMisses: return "branch misses";
+            case PerfEvent::DtlbMisses:   return "dTLB misses";
+            case PerfEvent::PageFaults:   return "page faults";
+            default:                      return "unknown";
+        }
+    }
+
+    //==============================================================================================
+    // struct : PerfSample
+    //==============================================================================================
+
+    constexpr auto PerfSample::has(PerfEvent event) const noexcept -> bool
+    {
+        return (available >> static_cast<uint32>(event) & 1) != 0;
+    }
+
+    constexpr auto PerfSample::operator[](PerfEvent event) const noexcept -> uint64
+    {
+        return values[static_cast<usize>(event)];
+    }
+
+    constexpr auto PerfSample::per(PerfEvent event, uint64 operations) const noexcept -> float64
+    {
+        if (!has(event) || operations == 0)
+        {
+            return std::numeric_limits<float64>::quiet_NaN();
+        }
+        return static_cast<float64>((*this)[event]) / static_cast<float64>(operations);
+    }
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+#include "core_types.hpp"
+#include "debug/ensure.hpp"
+#include "log/log.hpp"
+#include "order_book/command.hpp"
+#include "order_book/trade.hpp"
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+namespace flob
+{
+    // Fixed layout binary order entry, in the spirit of OUCH. Every message starts with its total length (uint16) and
+    // a one byte type, then fixed fields in network byte order with no padding:
+    //
+    //   EnterOrder   'O'  id u64, price u32, quantity u32, peak u32, stop u32, expiry i64 (ns), account u32, side u8,
+    //                     order type u8, flags u8
+    //   CancelOrder  'X'  id u64
+    //   ReplaceOrder 'U'  id u64, price u32, quantity u32
+    //   Executed     'E'  bid id u64, ask id u64, bid price u32, ask price u32, quantity u32
+    //   CancelResult 'C'  id u64, cancelled u8
+    //   Accepted     'A'  id u64
+    //   Rejected     'R'  id u64, reason u8 (OrderStatus)
+    //
+    // Every command gets exactly one final response, after its executions: Accepted for entries and replaces the book
+    // took, Rejected with the reason for the others, and CancelResult for cancels.
+    // Decoding reads the fields in place from the receive buffer, encoding writes them in place into the send buffer.
+    // Neither allocates, and the byte order is resolved at compile time.
+    namespace wire
+    {
+        enum class MessageType : uint8
+        {
+            EnterOrder   = 'O',
+            CancelOrder  = 'X',
+            ReplaceOrder = 'U',
+            Executed     = 'E',
+            CancelResult = 'C',
+            Accepted     = 'A',
+            Rejected     = 'R',
+        };
+
+        constexpr usize header_size = sizeof(uint16) + sizeof(MessageType);
+
+        constexpr usize enter_order_size   = header_size + 39;
+        constexpr usize cancel_order_size  = header_size + 8;
+        constexpr usize replace_order_size = header_size + 16;
+        constexpr usize executed_size      = header_size + 28;
+        constexpr usize cancel_result_size = header_size + 9;
+        constexpr usize accepted_size      = header_size + 8;
+        constexpr usize rejected_size      = header_size + 9;
+
+        // Largest message, enough for a scratch buffer of one message of any type.
+        constexpr usize max_message_size = enter_order_size;
+
+        // Expected size of a message type, 0 when the type is unknown.
+        [[nodiscard]] constexpr auto message_size(MessageType type) noexcept -> usize;
+
+        // Whether clients send messages of the type, as opposed to responses.
+        [[nodiscard]] constexpr auto is_command(MessageType type) noexcept -> bool;
+
+        static_assert(std::endian::native == std::endian::little || std::endian::native == std::endian::big, "Mixed endian is not supported");
+
+        // Unsigned integer of the size of a field, the unit of the byte swap.
+        template <typename T>
+            requires std::is_trivially_copyable_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)
+        using Bits = std::conditional_t<sizeof(T) == 1, uint8, std::conditional_t<sizeof(T) == 2, uint16, std::conditional_t<sizeof(T) == 4, uint32, uint64>>>;
+
+        template <typename T>
+        [[nodiscard]] auto load(const std::byte* data) noexcept -> T;
+
+        template <typename T>
+        auto store(std::byte* data, T value) noexcept -> void;
+    }
+
+    // Read-only view of one framed message inside a receive buffer. The buffer must outlive the view.
+    class MessageView
+    {
+    public:
+        constexpr explicit MessageView(std::span<const std::byte> bytes) noexcept;
+
+    public:
+        [[nodiscard]] constexpr auto size() const noexcept -> usize;
+        [[nodiscard]] constexpr auto bytes() const noexcept -> std::span<const std::byte>;
+        [[nodiscard]] auto           type() const noexcept -> wire::MessageType;
+
+        // Typed fields at their offset in the message.
+        template <typename T>
+        [[nodiscard]] auto field(usize offset) const noexcept -> T;
+
+    private:
+        std::span<const std::byte> _bytes;
+    };
+
+    // Splits the first message off `input`. Empty when the message is not complete yet, so the caller waits for more
+    // bytes, or when its length field is inconsistent, which `malformed` reports.
+    [[nodiscard]] auto next_message(std::span<const std::byte> input, bool& malformed) noexcept -> std::optional<MessageView>;
+
+    // False for a message that is not a command, and for a malformed command whose side, order type or flags are out of
+    // range, which is dropped. The timestamp of the command is left at 0.
+    [[nodiscard]] auto decode_command(const MessageView& message, OrderCommand& command) noexcept -> bool;
+
+    // Bytes written, 0 when the buffer is too small.
+    auto encode_command(std::span<std::byte> buffer, const OrderCommand& command) noexcept -> usize;
+    auto encode_execution(std::span<std::byte> buffer, const Trade& trade) noexcept -> usize;
+    auto encode_cancel_result(std::span<std::byte> buffer, OrderId order_id, bool cancelled) noexcept -> usize;
+    auto encode_accepted(std::span<std::byte> buffer, OrderId order_id) noexcept -> usize;
+    auto encode_rejected(std::span<std::byte> buffer, OrderId order_id, OrderStatus reason) noexcept -> usize;
+
+    struct BatchResult
+    {
+        usize consumed;   // Bytes of complete messages, the rest waits for the next receive
+        usize messages;
+        usize trades;
+        bool  malformed;  // Decoding stopped at a corrupt message, the stream cannot be resynchronized
+    };
+
+    // Decodes the commands of a receive buffer of one client session and applies them to the book in order. The
+    // session provides:
+    //
+    //   book_id(OrderId) -> std::optional<OrderId>  Id in the book of an order of the client, none when the client id
+    //                                               is unusable. A session only reaches its own orders this way.
+    //   account(AccountId) -> std::optional<AccountId>
+    //                                               Account to enter an order of the client under, given the one it
+    //                                               asked for, none to reject the entry.
+    //   reply(std::span<const std::byte>)           Response to the client, encoded with its own id into a scratch
+    //                                               buffer, one message at a time.
+    //   execution(const Trade&)                     Trade of a command, with book ids, for the owners of both sides.
+    template <typename Book, typename Session>
+    auto apply_messages(Book& book, std::span<const std::byte> input, Session& session) -> BatchResult;
+
+    //==============================================================================================
+    // namespace : wire
+    //==============================================================================================
+
+    constexpr auto wire::message_size(MessageType type) noexcept -> usize
+    {
+        switch (type)
+        {
+            case MessageType::EnterOrder:   return enter_order_size;
+            case MessageType::CancelOrder:  return cancel_order_size;
+            case MessageType::ReplaceOrder: return replace_order_size;
+            case MessageType::Executed:     return executed_size;
+            case MessageType::CancelResult: return cancel_result_size;
+            case MessageType::Accepted:     return accepted_size;
+            case MessageType::Rejected:     return rejected_size;
+            default:                        return 0;
+        }
+    }
+
+    constexpr auto wire::is_command(MessageType type) noexcept -> bool
+    {
+        return type == MessageType::EnterOrder || type == MessageType::CancelOrder || type == MessageType::ReplaceOrder;
+    }
+
+    template <typename T>
+    auto wire::load(const std::byte* data) noexcept -> T
+    {
+        // A copy of the bytes rather than a cast: fields are unaligned. Compilers turn the whole into a single load and
+        // byte swap, or a movbe.
+        std::array<std::byte, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), data, sizeof(T));
+
+        auto bits = std::bit_cast<Bits<T>>(bytes);
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            bits = std::byteswap(bits);
+        }
+        return std::bit_cast<T>(bits);
+    }
+
+    template <typename T>
+    auto wire::store(std::byte* data, T value) noexcept -> void
+    {
+        auto bits = std::bit_cast<Bits<T>>(value);
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            bits = std::byteswap(bits);
+        }
+
+        const auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(bits);
+        std::memcpy(data, bytes.data(), sizeof(T));
+    }
+
+    //==============================================================================================
+    // class : MessageView
+    //==============================================================================================
+
+    constexpr MessageView::MessageView(std::span<const std::byte> bytes) noexcept
+        : _bytes(bytes)
+    {}
+
+    constexpr auto MessageView::size() const noexcept -> usize
+    {
+        return _bytes.size();
+    }
+
+    constexpr auto MessageView::bytes() const noexcept -> std::span<const std::byte>
+    {
+        return _bytes;
+    }
+
+    inline auto MessageView::type() const noexcept -> wire::MessageType
+    {
+        return field<wire::MessageType>(sizeof(uint16));
+    }
+
+    template <typename T>
+    auto MessageView::field(usize offset) const noexcept -> T
+    {
+        ensure(offset + sizeof(T) <= _bytes.size(), "Field past the end of the message");
+        return wire::load<T>(_bytes.data() + offset);
+    }
+
+    //==============================================================================================
+    // Batches
+    //==============================================================================================
+
+    template <typename Book, typename Session>
+    auto apply_messages(Book& book, std::span<const std::byte> input, Session& session) -> BatchResult
+    {
+        BatchResult result(0, 0, 0, false);
+
+        std::array<std::byte, wire::max_message_size> scratch;
+        OrderCommand                                  command;
+        Trades                                        trades;  // Reused across the batch
+
+        while (const auto message = next_message(input.subspan(result.consumed), result.malformed))
+        {
+            if (!decode_command(*message, command))
+            {
+                if (!wire::is_command(message->type()))
+                {
+                    Log::warn("Unexpected message type {} in the command stream.", static_cast<uint8>(message->type()));
+                }
+                result.consumed += message->size();
+                continue;
+            }
+
+            result.consumed += message->size();
+            ++result.messages;
+
+            const auto reply     = [&](usize size) { session.reply(std::span<const std::byte>(scratch.data(), size)); };
+            const auto client_id = command.id;
+            const auto book_id   = session.book_id(client_id);
+            if (!book_id)
+            {
+                reply(command.type == CommandType::Cancel ? encode_cancel_result(scratch, client_id, false) : encode_rejected(scratch, client_id, OrderStatus::Invalid));
+                continue;
+            }
+            command.id = *book_id;
+
+            if (command.type == CommandType::Cancel)
+            {
+                reply(encode_cancel_result(scratch, client_id, book.cancel_order(command.id)));
+                continue;
+            }
+
+            if (command.type == CommandType::Add)
+            {
+                const auto account = session.account(command.account);
+                if (!account)
+                {
+                    reply(encode_rejected(scratch, client_id, OrderStatus::Invalid));
+                    continue;
+                }
+                command.account = *account;
+            }
+
+            trades.clear();
+            const auto status = book.apply(command, trades);
+            result.trades += trades.size();
+            for (const auto& trade : trades)
+            {
+                session.execution(trade);
+            }
+            reply(status == OrderStatus::Accepted ? encode_accepted(scratch, client_id) : encode_rejected(scratch, client_id, status));
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "debug/ensure.hpp"
+#include "order_book/order.hpp"
+#include "order_book/trade.hpp"
+#include "order_book/types.hpp"
+
+#include <chrono>
+
+namespace flob
+{
+    struct PnlConfig
+    {
+        float64                  taker_fee    = 0.0;  // Per lot, in price ticks
+        float64                  maker_rebate = 0.0;  // Per lot, in price ticks
+        std::chrono::nanoseconds bucket       = std::chrono::minutes(1);
+    };
+
+    struct AccountPnl
+    {
+        int64   position;      // Long when positive
+        float64 average_cost;  // Average entry price of the open position
+        float64 realized;
+        float64 fees;
+        float64 rebates;
+        uint64  volume;
+    };
+
+    // State of an account at the end of a time bucket in which it traded.
+    struct PnlBucket
+    {
+        TimePoint  start;
+        AccountId  account;
+        AccountPnl pnl;
+    };
+
+    // Position and PnL per account of a single instrument, fed fill by fill by the book. Accounts are dense ids
+    // indexing flat arrays. Open positions are only marked when queried, with whatever mark the caller picks, e.g. the
+    // book mid or microprice. Instead of keeping fills, the tracker appends one row per account that traded to
+    // `buckets()` every time a bucket closes.
+    class PnlTracker
+    {
+    public:
+        explicit PnlTracker(const PnlConfig& config = {});
+
+    public:
+        [[nodiscard]] constexpr auto is_tracked(AccountId account) const noexcept -> bool;
+        [[nodiscard]] constexpr auto pnl(AccountId account) const noexcept -> const AccountPnl&;
+
+        [[nodiscard]] auto unrealized(AccountId account, float64 mark) const noexcept -> float64;
+
+        // Realized and unrealized PnL, net of fees and rebates.
+        [[nodiscard]] auto total(AccountId account, float64 mark) const noexcept -> float64;
+
+        auto on_fill(AccountId account, Side side, Price price, Quantity quantity, Liquidity liquidity, TimePoint time) -> void;
+
+        // Closes the current bucket, e.g. at the end of a run.
+        auto flush() -> void;
+
+        [[nodiscard]] constexpr auto buckets() const noexcept -> const Vector<PnlBucket>&;
+        auto                         clear_buckets() noexcept -> void;
+
+    private:
+        PnlConfig _config;
+
+        Vector<AccountPnl> _accounts;
+        Vector<bool>       _traded;          // Accounts that traded in the current bucket
+        Vector<AccountId>  _traded_accounts;
+        int64              _bucket;          // Index of the current bucket since the epoch
+        Vector<PnlBucket>  _buckets;
+    };
+
+    //==============================================================================================
+    // class : PnlTracker
+    //==============================================================================================
+
+    constexpr auto PnlTracker::is_tracked(AccountId account) const noexcept -> bool
+    {
+        return account < _accounts.size();
+    }
+
+    constexpr auto PnlTracker::pnl(AccountId account) const noexcept -> const AccountPnl&
+    {
+        ensure(is_tracked(account), "Account never traded");
+        return _accounts[account];
+    }
+
+    constexpr auto PnlTracker::buckets() const noexcept -> const Vector<PnlBucket>&
+    {
+        return _buckets;
+    }
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "debug/ensure.hpp"
+#include "order_book/order.hpp"
+#include "order_book/types.hpp"
+
+#include <limits>
+
+namespace flob
+{
+    struct RiskLimits
+    {
+        Quantity max_order_quantity = std::numeric_limits<Quantity>::max();
+        uint64   max_order_notional = std::numeric_limits<uint64>::max();  // Price times quantity, in ticks
+        uint32   max_open_orders    = std::numeric_limits<uint32>::max();
+        int64    max_position       = std::numeric_limits<int64>::max();   // Absolute net position, open orders included
+    };
+
+    // Notional of an order without a reference price, e.g. a market order facing an empty side.
+    constexpr auto unknown_notional = std::numeric_limits<uint64>::max();
+
+    enum class RiskCheck : uint8
+    {
+        Accepted,
+        OrderQuantity,
+        OrderNotional,
+        OpenOrders,
+        Position,
+    };
+
+    struct AccountExposure
+    {
+        int64  position;  // Long when positive
+        int64  open_buy_quantity;
+        int64  open_sell_quantity;
+        uint32 open_orders;
+    };
+
+    // Pre-trade limits per account. Accounts are dense ids indexing flat arrays, so a check is a couple of loads and
+    // compares. Exposures are updated incrementally by the book on acceptance, fills and releases. There is no
+    // locking, a risk manager belongs to the matching thread and may be shared by the books of that thread.
+    // Accounts past the last one given limits, including invalid_account, are neither checked nor tracked.
+    class RiskManager
+    {
+    public:
+        RiskManager() = default;
+
+    public:
+        auto set_limits(AccountId account, const RiskLimits& limits) -> void;
+
+        [[nodiscard]] constexpr auto is_tracked(AccountId account) const noexcept -> bool;
+        [[nodiscard]] constexpr auto limits(AccountId account) const noexcept -> const RiskLimits&;
+        [[nodiscard]] constexpr auto exposure(AccountId account) const noexcept -> const AccountExposure&;
+
+        // Checks a new order and reserves it as open when accepted. `notional` is what the order can trade for, which
+        // the book works out since market orders have no price of their own. An unknown notional fails any notional
+        // limit.
+        constexpr auto check(const Order& order, uint64 notional) noexcept -> RiskCheck;
+
+        // Called once an order of the account has been filled by `quantity`, `filled` when nothing is left of it.
+        constexpr auto on_fill(AccountId account, Side side, Quantity quantity, bool filled) noexcept -> void;
+
+        // Called when an accepted order leaves the book without being filled, with the quantity it still had open:
+        // cancel, expiry or rejection.
+        constexpr auto on_release(AccountId account, Side side, Quantity quantity) noexcept -> void;
+
+    private:
+        Vector<RiskLimits>      _limits;
+        Vector<AccountExposure> _exposures;
+    };
+
+    //==============================================================================================
+    // class : RiskManager
+    //==============================================================================================
+
+    inline auto RiskManager::set_limits(AccountId account, const RiskLimits& limits) -> void
+    {
+        if (account >= _limits.size())
+        {
+            _limits.resize(account + 1);
+            _exposures.resize(account + 1);
+        }
+        _limits[account] = limits;
+    }
+
+    constexpr auto RiskManager::is_tracked(AccountId account) const noexcept -> bool
+    {
+        return account < _limits.size();
+    }
+
+    constexpr auto RiskManager::limits(AccountId account) const noexcept -> const RiskLimits&
+    {
+        ensure(is_tracked(account), "Account has no risk limits");
+        return _limits[account];
+    }
+
+    constexpr auto RiskManager::exposure(AccountId account) const noexcept -> const AccountExposure&
+    {
+        ensure(is_tracked(account), "Account has no risk limits");
+        return _exposures[account];
+    }
+
+    constexpr auto RiskManager::check(const Order& order, uint64 notional) noexcept -> RiskCheck
+    {
+        const auto account = order.account();
+        if (!is_tracked(account))
+        {
+            return RiskCheck::Accepted;
+        }
+
+        const auto& limits   = _limits[account];
+        auto&       exposure = _exposures[account];
+        const auto  quantity = order.total_quantity();
+
+        if (quantity > limits.max_order_quantity)
+        {
+            return RiskCheck::OrderQuantity;
+        }
+        if (notional > limits.max_order_notional || (notional == unknown_notional && limits.max_order_notional != std::numeric_limits<uint64>::max()))
+        {
+            return RiskCheck::OrderNotional;
+        }
+        if (exposure.open_orders >= limits.max_open_orders)
+        {
+            return RiskCheck::OpenOrders;
+        }
+
+        // Worst case: every open order on the same side fills.
+        const auto worst = order.side() == Side::Buy ? exposure.position + exposure.open_buy_quantity + quantity
+                                                     : exposure.open_sell_quantity + quantity - exposure.position;
+        if (worst > limits.max_position)
+        {
+            return RiskCheck::Position;
+        }
+
+        (order.side() == Side::Buy ? exposure.open_buy_quantity : exposure.open_sell_quantity) += quantity;
+        ++exposure.open_orders;
+        return RiskCheck::Accepted;
+    }
+
+    constexpr auto RiskManager::on_fill(AccountId account, Side side, Quantity quantity, bool filled) noexcept -> void
+    {
+        if (!is_tracked(account))
+        {
+            return;
+        }
+
+        auto& exposure = _exposures[account];
+        if (side == Side::Buy)
+        {
+            exposure.position += quantity;
+            exposure.open_buy_quantity -= quantity;
+        }
+        else
+        {
+            exposure.position -= quantity;
+            exposure.open_sell_quantity -= quantity;
+        }
+
+        if (filled)
+        {
+            --exposure.open_orders;
+        }
+    }
+
+    constexpr auto RiskManager::on_release(AccountId account, Side side, Quantity quantity) noexcept -> void
+    {
+        if (!is_tracked(account))
+        {
+            return;
+        }
+
+        auto& exposure = _exposures[account];
+        (side == Side::Buy ? exposure.open_buy_quantity : exposure.open_sell_quantity) -= quantity;
+        --exposure.open_orders;
+    }
+}
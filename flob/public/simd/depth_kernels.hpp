@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core_types.hpp"
+
+#include <string_view>
+
+namespace flob
+{
+    enum class SimdLevel : uint8
+    {
+        Scalar,  // Portable loops, on every target
+        Avx2,    // x86-64 with AVX2, checked at runtime
+    };
+
+    [[nodiscard]] constexpr auto to_string(SimdLevel level) noexcept -> std::string_view;
+
+    // Linear scans over the quantities, and prices, of consecutive levels, best first. Cumulative values are 64 bits
+    // wide so that they never wrap over any number of 32-bit quantities.
+    struct DepthKernels
+    {
+        SimdLevel level;
+
+        // Sum of the `count` quantities.
+        uint64 (*sum)(const uint32* quantities, usize count) noexcept;
+
+        // cumulative[i] = quantities[0] + ... + quantities[i].
+        void (*prefix_sum)(const uint32* quantities, uint64* cumulative, usize count) noexcept;
+
+        // First index at which the cumulative quantity reaches `threshold`, `count` when it never does.
+        usize (*find_cumulative)(const uint32* quantities, usize count, uint64 threshold) noexcept;
+
+        // Sum of prices[i] * quantities[i], e.g. the notional of a sweep.
+        uint64 (*dot)(const uint32* prices, const uint32* quantities, usize count) noexcept;
+    };
+
+    // Best level the CPU supports, detected once.
+    [[nodiscard]] auto simd_level() noexcept -> SimdLevel;
+
+    // Kernels of the best supported level, or of `level` for comparisons, falling back to the scalar ones when the CPU
+    // does not support it. Results are identical whatever the level.
+    [[nodiscard]] auto depth_kernels() noexcept -> const DepthKernels&;
+    [[nodiscard]] auto depth_kernels(SimdLevel level) noexcept -> const DepthKernels&;
+
+    //==============================================================================================
+    // enum : SimdLevel
+    //==============================================================================================
+
+    constexpr auto to_string(SimdLevel level) noexcept -> std::string_view
+    {
+        switch (level)
+        {
+            case SimdLevel::Scalar: return "scalar";
+            case SimdLevel::Avx2:   return "avx2";
+            default:                return "unknown";
+        }
+    }
+}
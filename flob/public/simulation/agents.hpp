@@ -0,0 +1,44 @@
+#pragma once
+
+#include "core_types.hpp"
+#include "order_book/types.hpp"
+#include "simulation/market_simulator.hpp"
+
+#include <chrono>
+
+namespace flob
+{
+    // Quotes both sides around the mid on every update, skewed against its inventory, and stops quoting the side that
+    // would grow a position beyond the limit.
+    struct MarketMakerConfig
+    {
+        Price    half_spread  = 2;
+        Quantity quantity     = 20;
+        int64    max_position = 500;
+        float64  skew         = 0.01;  // Ticks of skew per unit of position
+    };
+
+    // Sends marketable orders at random, Poisson-distributed times.
+    struct TakerConfig
+    {
+        float64  rate         = 2'000.0;  // Orders per second
+        Quantity min_quantity = 1;
+        Quantity max_quantity = 50;
+    };
+
+    // Rests limit orders at a geometric distance from the mid it last saw and cancels its oldest ones.
+    struct NoiseTraderConfig
+    {
+        float64  rate           = 20'000.0;  // Orders per second
+        float64  distance_decay = 0.2;
+        uint32   max_distance   = 50;
+        Quantity min_quantity   = 1;
+        Quantity max_quantity   = 100;
+        usize    max_live       = 200;     // Resting orders kept before the oldest are cancelled
+        Price    initial_mid    = 10'000;  // Used until the book has both sides
+    };
+
+    [[nodiscard]] auto market_maker(MarketSimulator& simulator, AgentId agent, MarketMakerConfig config) -> AgentTask;
+    [[nodiscard]] auto taker(MarketSimulator& simulator, AgentId agent, TakerConfig config) -> AgentTask;
+    [[nodiscard]] auto noise_trader(MarketSimulator& simulator, AgentId agent, NoiseTraderConfig config) -> AgentTask;
+}
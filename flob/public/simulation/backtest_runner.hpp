@@ -0,0 +1,81 @@
+#pragma once
+
+#include "concurrency/work_stealing_pool.hpp"
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "order_book/order_book.hpp"
+#include "order_book/workload.hpp"
+
+#include <chrono>
+#include <thread>
+#include <type_traits>
+
+namespace flob
+{
+    // One independent simulation: a fresh book fed with a synthetic workload.
+    struct BacktestJob
+    {
+        OrderBookConfig book;  // Risk, PnL and feature consumers must belong to this job alone
+        WorkloadConfig  workload;
+        usize           commands = 100'000;
+    };
+
+    struct BacktestResult
+    {
+        uint64                   commands;
+        uint64                   trades;
+        uint64                   volume;
+        Price                    last_price;
+        usize                    resting_orders;
+        std::chrono::nanoseconds elapsed;
+    };
+
+    // Replays the workload of a job into a book of its own, driven by the command timestamps.
+    [[nodiscard]] auto run_backtest(const BacktestJob& job) -> BacktestResult;
+
+    // Runs independent simulations in parallel on a work-stealing pool. Every simulation builds its book, flow and
+    // orders on the worker that picks it up, so workers share nothing but the job list. Each result is written once,
+    // by its worker, to the slot of its job, which needs no lock and keeps the output in job order.
+    class BacktestRunner
+    {
+    public:
+        explicit BacktestRunner(usize workers = std::thread::hardware_concurrency());
+
+    public:
+        [[nodiscard]] constexpr auto workers() const noexcept -> usize;
+
+        // Scheduling statistics of the last run.
+        [[nodiscard]] constexpr auto stats() const noexcept -> const PoolStats&;
+
+        template <typename Job, typename Simulate>
+        auto run(const Vector<Job>& jobs, Simulate&& simulate) -> Vector<std::invoke_result_t<Simulate&, const Job&>>;
+
+        auto run(const Vector<BacktestJob>& jobs) -> Vector<BacktestResult>;
+
+    private:
+        WorkStealingPool _pool;
+        PoolStats        _stats;
+    };
+
+    //==============================================================================================
+    // class : BacktestRunner
+    //==============================================================================================
+
+    constexpr auto BacktestRunner::workers() const noexcept -> usize
+    {
+        return _pool.size();
+    }
+
+    constexpr auto BacktestRunner::stats() const noexcept -> const PoolStats&
+    {
+        return _stats;
+    }
+
+    template <typename Job, typename Simulate>
+    auto BacktestRunner::run(const Vector<Job>& jobs, Simulate&& simulate) -> Vector<std::invoke_result_t<Simulate&, const Job&>>
+    {
+        Vector<std::invoke_result_t<Simulate&, const Job&>> results(jobs.size());
+        _stats = _pool.parallel_for(jobs.size(), [&](usize, usize index) { results[index] = simulate(jobs[index]); });
+        return results;
+    }
+}
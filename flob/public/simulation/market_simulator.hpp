@@ -0,0 +1,383 @@
+#pragma once
+
+#include "analytics/feature_stream.hpp"
+#include "containers/vector.hpp"
+#include "core_types.hpp"
+#include "misc/random.hpp"
+#include "order_book/command.hpp"
+#include "order_book/order_book.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace flob
+{
+    using AgentId = uint32;
+
+    // Delays between an agent and the venue, both ways. Fills travel with market data.
+    struct AgentLatency
+    {
+        std::chrono::nanoseconds order_entry = std::chrono::microseconds(50);
+        std::chrono::nanoseconds market_data = std::chrono::microseconds(20);
+    };
+
+    struct SimulatorConfig
+    {
+        OrderBookConfig book;  // Driven by the simulated clock, starting at book.start_time
+        uint64          seed = 42;
+    };
+
+    // What an agent sees of the book, as of `time`.
+    struct MarketData
+    {
+        TimePoint time;
+        TopOfBook top;
+        Price     last_price = invalid_price;
+        Quantity  volume     = 0;  // Traded by the event that produced the update
+    };
+
+    struct SimulationStats
+    {
+        uint64 events;
+        uint64 orders;  // Commands that reached the book
+        uint64 trades;
+        uint64 volume;
+    };
+
+    // Coroutine type of an agent. Agents start on the first event of the simulation and are destroyed with it. The
+    // frame is allocated once, when the agent is added.
+    class AgentTask
+    {
+    public:
+        struct promise_type
+        {
+            auto get_return_object() noexcept -> AgentTask { return AgentTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            auto initial_suspend() const noexcept -> std::suspend_always { return {}; }
+            auto final_suspend() const noexcept -> std::suspend_always { return {}; }
+            auto return_void() const noexcept -> void {}
+            auto unhandled_exception() const noexcept -> void { std::terminate(); }
+        };
+
+    public:
+        AgentTask() noexcept = default;
+        ~AgentTask() noexcept;
+
+        AgentTask(const AgentTask&) = delete;
+        AgentTask(AgentTask&& other) noexcept;
+
+        auto operator=(const AgentTask&) -> AgentTask& = delete;
+        auto operator=(AgentTask&& other) noexcept -> AgentTask&;
+
+    public:
+        [[nodiscard]] constexpr auto handle() const noexcept -> std::coroutine_handle<promise_type>;
+
+    private:
+        explicit constexpr AgentTask(std::coroutine_handle<promise_type> handle) noexcept;
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    // Discrete-event kernel of a multi-agent market. Agents are coroutines that await market data and timers, their
+    // orders reach the book after their order entry latency and the resulting updates reach every agent after its
+    // market data latency. Everything is ordered by a single event queue on the simulated clock and runs on the calling
+    // thread, so a run is reproducible and an event costs a heap operation and a coroutine resume at most.
+    class MarketSimulator
+    {
+    public:
+        explicit MarketSimulator(const SimulatorConfig& config = {});
+
+        MarketSimulator(const MarketSimulator&)                    = delete;
+        auto operator=(const MarketSimulator&) -> MarketSimulator& = delete;
+
+    public:
+        // `body(simulator, agent)` returns the AgentTask of the agent. The body is not kept, so it must not be a
+        // coroutine lambda with captures: state goes into the parameters of the coroutine.
+        template <typename Body>
+        auto add_agent(const AgentLatency& latency, Body&& body) -> AgentId;
+
+        // Processes events up to `duration` of simulated time, or until none are left.
+        auto run(std::chrono::nanoseconds duration) -> void;
+
+        [[nodiscard]] constexpr auto now() const noexcept -> TimePoint;
+        [[nodiscard]] constexpr auto book() const noexcept -> const OrderBook&;
+        [[nodiscard]] constexpr auto stats() const noexcept -> const SimulationStats&;
+        [[nodiscard]] constexpr auto agent_count() const noexcept -> usize;
+
+        //--------------------------------------------------------------------------------------------------------------
+        // Agent side
+        //--------------------------------------------------------------------------------------------------------------
+
+        // Resumes the agent after `delay`.
+        [[nodiscard]] auto sleep(AgentId agent, std::chrono::nanoseconds delay) noexcept;
+
+        // Resumes the agent with the latest update it received, at once if it has not read it yet. Updates that arrive
+        // while the agent is busy are conflated. Agents await on their own frame only, never from a nested coroutine.
+        [[nodiscard]] auto market_data(AgentId agent) noexcept;
+
+        // Latest update received by the agent, without waiting.
+        [[nodiscard]] constexpr auto last_market_data(AgentId agent) const noexcept -> const MarketData&;
+
+        // Position of the agent from the fills it has been told about.
+        [[nodiscard]] constexpr auto position(AgentId agent) const noexcept -> int64;
+
+        [[nodiscard]] constexpr auto random(AgentId agent) noexcept -> Random&;
+
+        // Sends an order, its id is chosen by the simulator and encodes the agent.
+        auto submit(AgentId agent, OrderType type, Side side, Price price, Quantity quantity) -> OrderId;
+        auto cancel(AgentId agent, OrderId order_id) -> void;
+        auto modify(AgentId agent, OrderId order_id, Price price, Quantity quantity) -> void;
+
+    private:
+        enum class EventType : uint8
+        {
+            Resume,
+            OrderEntry,  // `value` is the slot of the command
+            Update,      // `value` is the slot of the update
+            BuyFill,     // `value` is the quantity
+            SellFill,
+        };
+
+        struct Event
+        {
+            uint64    time;      // Nanoseconds since the start
+            uint64    sequence;  // Breaks ties in scheduling order
+            AgentId   agent;
+            uint32    value;
+            EventType type;
+
+            // Heap order, the earliest event is on top.
+            [[nodiscard]] constexpr auto operator>(const Event& other) const noexcept -> bool;
+        };
+
+        struct Agent
+        {
+            AgentLatency latency;
+            AgentTask    task;
+            MarketData   last;
+            Random       random;
+            int64        position = 0;
+            uint64       orders   = 0;
+            bool         unread   = false;  // `last` arrived after the last read
+            bool         waiting  = false;  // Suspended in market_data()
+        };
+
+        // Updates are shared by every delivery of a publication, a slot is reused once all of them are done.
+        struct Update
+        {
+            MarketData data;
+            usize      pending;
+        };
+
+        class SleepAwaiter;
+        class MarketDataAwaiter;
+
+    private:
+        auto register_agent(const AgentLatency& latency, AgentTask task) -> AgentId;
+
+        auto schedule(std::chrono::nanoseconds delay, EventType type, AgentId agent, uint32 value) -> void;
+        auto process(const Event& event) -> void;
+
+        auto send(AgentId agent, const OrderCommand& command) -> void;
+        auto execute(const OrderCommand& command) -> void;
+        auto publish(const Trades& trades) -> void;
+
+    private:
+        OrderBook     _book;
+        TimePoint     _start;
+        uint64        _now      = 0;
+        uint64        _sequence = 0;
+        uint64        _seed;
+        Vector<Event> _events;
+
+        Vector<Agent>        _agents;
+        Vector<OrderCommand> _commands;  // In flight to the book
+        Vector<uint32>       _free_commands;
+        Vector<Update>       _updates;  // In flight to the agents
+        Vector<uint32>       _free_updates;
+        TopOfBook            _top;
+
+        SimulationStats _stats;
+    };
+
+    class MarketSimulator::SleepAwaiter
+    {
+    public:
+        constexpr SleepAwaiter(MarketSimulator& simulator, AgentId agent, std::chrono::nanoseconds delay) noexcept;
+
+    public:
+        constexpr auto await_ready() const noexcept -> bool;
+        auto           await_suspend(std::coroutine_handle<> coroutine) const -> void;
+        constexpr auto await_resume() const noexcept -> void;
+
+    private:
+        MarketSimulator&         _simulator;
+        AgentId                  _agent;
+        std::chrono::nanoseconds _delay;
+    };
+
+    class MarketSimulator::MarketDataAwaiter
+    {
+    public:
+        constexpr MarketDataAwaiter(MarketSimulator& simulator, AgentId agent) noexcept;
+
+    public:
+        constexpr auto await_ready() const noexcept -> bool;
+        constexpr auto await_suspend(std::coroutine_handle<> coroutine) const noexcept -> void;
+        constexpr auto await_resume() const noexcept -> MarketData;
+
+    private:
+        MarketSimulator& _simulator;
+        AgentId          _agent;
+    };
+
+    //==============================================================================================
+    // class : AgentTask
+    //==============================================================================================
+
+    constexpr AgentTask::AgentTask(std::coroutine_handle<promise_type> handle) noexcept
+        : _handle(handle)
+    {}
+
+    inline AgentTask::~AgentTask() noexcept
+    {
+        if (_handle)
+        {
+            _handle.destroy();
+        }
+    }
+
+    inline AgentTask::AgentTask(AgentTask&& other) noexcept
+        : _handle(std::exchange(other._handle, nullptr))
+    {}
+
+    inline auto AgentTask::operator=(AgentTask&& other) noexcept -> AgentTask&
+    {
+        if (this != &other)
+        {
+            if (_handle)
+            {
+                _handle.destroy();
+            }
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+
+    constexpr auto AgentTask::handle() const noexcept -> std::coroutine_handle<promise_type>
+    {
+        return _handle;
+    }
+
+    //==============================================================================================
+    // class : MarketSimulator
+    //==============================================================================================
+
+    template <typename Body>
+    auto MarketSimulator::add_agent(const AgentLatency& latency, Body&& body) -> AgentId
+    {
+        const auto agent = static_cast<AgentId>(_agents.size());
+        return register_agent(latency, std::forward<Body>(body)(*this, agent));
+    }
+
+    constexpr auto MarketSimulator::now() const noexcept -> TimePoint
+    {
+        return _start + std::chrono::duration_cast<TimePoint::duration>(std::chrono::nanoseconds(_now));
+    }
+
+    constexpr auto MarketSimulator::book() const noexcept -> const OrderBook&
+    {
+        return _book;
+    }
+
+    constexpr auto MarketSimulator::stats() const noexcept -> const SimulationStats&
+    {
+        return _stats;
+    }
+
+    constexpr auto MarketSimulator::agent_count() const noexcept -> usize
+    {
+        return _agents.size();
+    }
+
+    inline auto MarketSimulator::sleep(AgentId agent, std::chrono::nanoseconds delay) noexcept
+    {
+        return SleepAwaiter(*this, agent, delay);
+    }
+
+    inline auto MarketSimulator::market_data(AgentId agent) noexcept
+    {
+        return MarketDataAwaiter(*this, agent);
+    }
+
+    constexpr auto MarketSimulator::last_market_data(AgentId agent) const noexcept -> const MarketData&
+    {
+        return _agents[agent].last;
+    }
+
+    constexpr auto MarketSimulator::position(AgentId agent) const noexcept -> int64
+    {
+        return _agents[agent].position;
+    }
+
+    constexpr auto MarketSimulator::random(AgentId agent) noexcept -> Random&
+    {
+        return _agents[agent].random;
+    }
+
+    constexpr auto MarketSimulator::Event::operator>(const Event& other) const noexcept -> bool
+    {
+        return time != other.time ? time > other.time : sequence > other.sequence;
+    }
+
+    //==============================================================================================
+    // class : MarketSimulator::SleepAwaiter
+    //==============================================================================================
+
+    constexpr MarketSimulator::SleepAwaiter::SleepAwaiter(MarketSimulator& simulator, AgentId agent, std::chrono::nanoseconds delay) noexcept
+        : _simulator(simulator)
+        , _agent(agent)
+        , _delay(delay)
+    {}
+
+    constexpr auto MarketSimulator::SleepAwaiter::await_ready() const noexcept -> bool
+    {
+        return false;
+    }
+
+    inline auto MarketSimulator::SleepAwaiter::await_suspend(std::coroutine_handle<>) const -> void
+    {
+        // Agents are resumed through their task, the handle of the awaiting frame is not needed.
+        _simulator.schedule(_delay, EventType::Resume, _agent, 0);
+    }
+
+    constexpr auto MarketSimulator::SleepAwaiter::await_resume() const noexcept -> void {}
+
+    //==============================================================================================
+    // class : MarketSimulator::MarketDataAwaiter
+    //==============================================================================================
+
+    constexpr MarketSimulator::MarketDataAwaiter::MarketDataAwaiter(MarketSimulator& simulator, AgentId agent) noexcept
+        : _simulator(simulator)
+        , _agent(agent)
+    {}
+
+    constexpr auto MarketSimulator::MarketDataAwaiter::await_ready() const noexcept -> bool
+    {
+        return _simulator._agents[_agent].unread;
+    }
+
+    constexpr auto MarketSimulator::MarketDataAwaiter::await_suspend(std::coroutine_handle<>) const noexcept -> void
+    {
+        _simulator._agents[_agent].waiting = true;
+    }
+
+    constexpr auto MarketSimulator::MarketDataAwaiter::await_resume() const noexcept -> MarketData
+    {
+        auto& agent  = _simulator._agents[_agent];
+        agent.unread = false;
+        return agent.last;
+    }
+}
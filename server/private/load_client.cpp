@@ -0,0 +1,306 @@
+#include <containers/vector.hpp>
+#include <log/log.hpp>
+#include <order_book/workload.hpp>
+#include <protocol/order_entry.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace flob;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::string path            = "/tmp/flob.sock";
+        uint16      port            = 0;
+        int32       seconds         = 2;   // Per connection count
+        usize       window          = 8;   // Commands in flight per connection
+        usize       max_connections = 64;
+    };
+
+    // One order entry session. Responses come back in command order, so the send times form a queue and the final
+    // response of each command (Accepted, Rejected or CancelResult) closes the oldest one.
+    struct Session
+    {
+        int32                     fd = -1;
+        WorkloadGenerator         generator;
+        Vector<std::byte>         rx;
+        usize                     rx_size = 0;
+        Vector<Clock::time_point> sent;
+        usize                     oldest      = 0;
+        usize                     outstanding = 0;
+    };
+
+    struct RoundResult
+    {
+        Vector<uint64> latencies;  // Nanoseconds
+        uint64         executions = 0;
+        float64        seconds    = 0.0;
+    };
+
+    auto connect_to(const Options& options) -> int32
+    {
+        int32 fd = -1;
+        if (options.port == 0)
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, options.path.c_str(), sizeof(address.sun_path) - 1);
+
+            fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        else
+        {
+            sockaddr_in address{};
+            address.sin_family      = AF_INET;
+            address.sin_port        = htons(options.port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                ::close(fd);
+                fd = -1;
+            }
+
+            const int32 enable = 1;
+            if (fd >= 0)
+            {
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            }
+        }
+
+        if (fd < 0)
+        {
+            Log::error("Failed to connect: {}.", std::strerror(errno));
+        }
+        return fd;
+    }
+
+    auto send_all(int32 fd, const std::byte* data, usize size) -> bool
+    {
+        while (size > 0)
+        {
+            const auto sent = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (sent < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            data += sent;
+            size -= static_cast<usize>(sent);
+        }
+        return true;
+    }
+
+    // Encodes the next commands of the session until its window is full.
+    auto refill(Session& session, usize window, Vector<std::byte>& buffer) -> void
+    {
+        const auto now = Clock::now();
+        while (session.outstanding < window)
+        {
+            const auto command = session.generator.next();
+
+            const auto offset = buffer.size();
+            buffer.resize(offset + wire::max_message_size);
+            buffer.resize(offset + encode_command(std::span<std::byte>(buffer.data() + offset, wire::max_message_size), command));
+
+            session.sent[(session.oldest + session.outstanding) % window] = now;
+            ++session.outstanding;
+        }
+    }
+
+    auto run_round(const Options& options, usize connections) -> RoundResult
+    {
+        RoundResult result;
+
+        const auto      epoll = ::epoll_create1(0);
+        Vector<Session> sessions(connections);
+        bool            connected = true;
+        for (usize i = 0; i < connections; ++i)
+        {
+            auto& session = sessions[i];
+
+            WorkloadConfig workload;
+            workload.seed = 42 + i;
+
+            // Every connection is its own id namespace on the server, the sessions may reuse the same ids.
+            session.fd        = connect_to(options);
+            session.generator = WorkloadGenerator(workload);
+            session.rx.resize(64 * 1024);
+            session.sent.resize(options.window);
+            if (session.fd < 0)
+            {
+                connected = false;
+                break;
+            }
+
+            epoll_event event{};
+            event.events   = EPOLLIN;
+            event.data.u64 = i;
+            ::epoll_ctl(epoll, EPOLL_CTL_ADD, session.fd, &event);
+        }
+
+        Vector<std::byte> buffer;
+        const auto        start    = Clock::now();
+        const auto        deadline = connected ? start + std::chrono::seconds(options.seconds) : start;
+        for (auto& session : sessions)
+        {
+            if (!connected)
+            {
+                break;
+            }
+            buffer.clear();
+            refill(session, options.window, buffer);
+            send_all(session.fd, buffer.data(), buffer.size());
+        }
+
+        epoll_event events[64];
+        bool        failed = false;
+        while (!failed && Clock::now() < deadline)
+        {
+            const auto count = ::epoll_wait(epoll, events, 64, 100);
+            for (int32 e = 0; e < count && !failed; ++e)
+            {
+                auto&      session  = sessions[events[e].data.u64];
+                const auto received = ::recv(session.fd, session.rx.data() + session.rx_size, session.rx.size() - session.rx_size, MSG_DONTWAIT);
+                if (received == 0)
+                {
+                    Log::error("The server closed the connection.");
+                    failed = true;
+                    break;
+                }
+                if (received < 0)
+                {
+                    continue;
+                }
+                session.rx_size += static_cast<usize>(received);
+
+                const auto now       = Clock::now();
+                usize      consumed  = 0;
+                bool       malformed = false;
+                while (const auto message = next_message(std::span<const std::byte>(session.rx.data() + consumed, session.rx_size - consumed), malformed))
+                {
+                    consumed += message->size();
+                    if (message->type() == wire::MessageType::Executed)
+                    {
+                        ++result.executions;
+                        continue;
+                    }
+
+                    result.latencies.push_back(static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - session.sent[session.oldest]).count()));
+                    session.oldest = (session.oldest + 1) % options.window;
+                    --session.outstanding;
+                }
+                if (malformed)
+                {
+                    Log::error("The server sent a malformed stream.");
+                    failed = true;
+                    break;
+                }
+
+                session.rx_size -= consumed;
+                std::memmove(session.rx.data(), session.rx.data() + consumed, session.rx_size);
+
+                buffer.clear();
+                refill(session, options.window, buffer);
+                send_all(session.fd, buffer.data(), buffer.size());
+            }
+        }
+        result.seconds = std::chrono::duration<float64>(Clock::now() - start).count();
+
+        for (const auto& session : sessions)
+        {
+            if (session.fd >= 0)
+            {
+                ::close(session.fd);
+            }
+        }
+        if (failed)
+        {
+            result.latencies.clear();
+        }
+        ::close(epoll);
+        return result;
+    }
+
+    auto percentile(const Vector<uint64>& sorted, float64 rank) -> float64
+    {
+        const auto index = std::min(static_cast<usize>(rank * static_cast<float64>(sorted.size())), sorted.size() - 1);
+        return static_cast<float64>(sorted[index]) / 1e3;
+    }
+}
+
+// Drives a running flob_server with 1 to 64 connections, each keeping a window of commands in flight, and reports the
+// throughput and the round trip latency of every command from its send to its final response.
+//
+//   flob_load [--tcp PORT] [--seconds N] [--window N] [SOCKET_PATH]
+auto main(int32 argc, char** argv) -> int32
+{
+    Options options;
+    for (int32 i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        if (argument == "--tcp" && i + 1 < argc)
+        {
+            options.port = static_cast<uint16>(std::atoi(argv[++i]));
+        }
+        else if (argument == "--seconds" && i + 1 < argc)
+        {
+            options.seconds = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (argument == "--window" && i + 1 < argc)
+        {
+            options.window = static_cast<usize>(std::max(std::atoi(argv[++i]), 1));
+        }
+        else if (!argument.starts_with("--"))
+        {
+            options.path = argument;
+        }
+        else
+        {
+            Log::error("Unknown option {}.", argument);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Log::info("{:>5} | {:>12} | {:>10} | {:>10} | {:>10} | {:>10}", "conns", "msgs/s", "p50 us", "p99 us", "p99.9 us", "fills/s");
+    for (usize connections = 1; connections <= options.max_connections; connections *= 2)
+    {
+        auto result = run_round(options, connections);
+        if (result.latencies.empty())
+        {
+            return EXIT_FAILURE;
+        }
+
+        std::sort(result.latencies.begin(), result.latencies.end());
+        Log::info("{:>5} | {:>12.0f} | {:>10.1f} | {:>10.1f} | {:>10.1f} | {:>10.0f}", connections, static_cast<float64>(result.latencies.size()) / result.seconds,
+                  percentile(result.latencies, 0.5), percentile(result.latencies, 0.99), percentile(result.latencies, 0.999),
+                  static_cast<float64>(result.executions) / result.seconds);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include <log/log.hpp>
+#include <net/order_server.hpp>
+
+#include <csignal>
+#include <cstdlib>
+#include <string_view>
+
+using namespace flob;
+
+namespace
+{
+    OrderServer* running_server = nullptr;
+
+    auto on_signal(int32) -> void
+    {
+        if (running_server)
+        {
+            running_server->stop();
+        }
+    }
+}
+
+// Serves one book until interrupted.
+//
+//   flob_server [--tcp PORT] [--busy-poll] [SOCKET_PATH]
+auto main(int32 argc, char** argv) -> int32
+{
+    OrderServerConfig config;
+    for (int32 i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        if (argument == "--tcp" && i + 1 < argc)
+        {
+            config.port = static_cast<uint16>(std::atoi(argv[++i]));
+        }
+        else if (argument == "--busy-poll")
+        {
+            config.busy_poll = true;
+        }
+        else if (!argument.starts_with("--"))
+        {
+            config.path = argument;
+        }
+        else
+        {
+            Log::error("Unknown option {}.", argument);
+            return EXIT_FAILURE;
+        }
+    }
+
+    OrderBook   book(OrderBookConfig{});
+    OrderServer server(book, config);
+    if (!server.start())
+    {
+        return EXIT_FAILURE;
+    }
+
+    running_server = &server;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    if (config.port != 0)
+    {
+        Log::info("Listening on 127.0.0.1:{}{}.", config.port, config.busy_poll ? " with busy polling" : "");
+    }
+    else
+    {
+        Log::info("Listening on {}{}.", config.path, config.busy_poll ? " with busy polling" : "");
+    }
+    server.run();
+
+    const auto& stats = server.stats();
+    Log::info("Served {} connections: {} messages, {} trades, {} bytes in, {} bytes out, {} wakeups", stats.connections, stats.messages,
+              stats.trades, stats.bytes_received, stats.bytes_sent, stats.wakeups);
+    return EXIT_SUCCESS;
+}